@@ -0,0 +1,171 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2022 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+import QtQuick
+import org.wangwenx190.QtAcrylicMaterial
+
+Item {
+    id: root
+
+    // Set by main.cpp.
+    property string scenario: ""
+    property int radius: 60
+    property url referenceVertexShader
+    property url referenceFragmentShader
+
+    readonly property bool ready: (loader.status === Loader.Ready) && loader.item.ready
+
+    // Detailed content which changes on every frame, so that all the passes have
+    // to run on every frame as well.
+    Item {
+        id: content
+        anchors.fill: parent
+
+        Grid {
+            anchors.fill: parent
+            columns: 16
+
+            Repeater {
+                model: 16 * 9
+
+                Rectangle {
+                    required property int index
+                    width: content.width / 16
+                    height: content.height / 9
+                    color: Qt.hsla((index % 16) / 16, 0.8, ((index % 3) + 1) / 4, 1)
+                }
+            }
+        }
+
+        Rectangle {
+            anchors.centerIn: parent
+            width: parent.height / 2
+            height: width
+            color: Qt.color("white")
+
+            NumberAnimation on rotation {
+                from: 0
+                to: 360
+                duration: 2000
+                loops: Animation.Infinite
+            }
+        }
+    }
+
+    ShaderEffectSource {
+        id: contentSource
+        anchors.fill: parent
+        sourceItem: content
+        hideSource: true
+        visible: false
+    }
+
+    Loader {
+        id: loader
+        anchors.fill: parent
+        sourceComponent: {
+            switch (root.scenario) {
+            case "pertexel":
+                return perTexelBlur;
+            case "gaussian":
+                return gaussianBlur;
+            case "dualkawase":
+                return dualKawaseBlur;
+            case "box":
+                return boxBlur;
+            }
+            return null;
+        }
+    }
+
+    // GaussianBlur's large kernel path before the texels were paired.
+    Component {
+        id: perTexelBlur
+
+        Item {
+            readonly property bool ready: (horizontalPass.status === ShaderEffect.Compiled)
+                                          && (verticalPass.status === ShaderEffect.Compiled)
+
+            ShaderEffect {
+                id: horizontalPass
+                anchors.fill: parent
+                property var source: contentSource
+                property vector2d dirstep: Qt.vector2d(1 / width, 0)
+                vertexShader: root.referenceVertexShader
+                fragmentShader: root.referenceFragmentShader
+            }
+
+            ShaderEffectSource {
+                id: horizontalSource
+                anchors.fill: parent
+                sourceItem: horizontalPass
+                hideSource: true
+                visible: false
+            }
+
+            ShaderEffect {
+                id: verticalPass
+                anchors.fill: parent
+                property var source: horizontalSource
+                property vector2d dirstep: Qt.vector2d(0, 1 / height)
+                vertexShader: root.referenceVertexShader
+                fragmentShader: root.referenceFragmentShader
+            }
+        }
+    }
+
+    // Above the varying limit, which is the case for the default radius, this is
+    // the paired texels path.
+    Component {
+        id: gaussianBlur
+
+        GaussianBlur {
+            source: contentSource
+            radius: root.radius
+            samples: (root.radius * 2)
+        }
+    }
+
+    Component {
+        id: dualKawaseBlur
+
+        GaussianBlur {
+            source: contentSource
+            radius: root.radius
+            samples: (root.radius * 2)
+            algorithm: GaussianBlur.DualKawase
+        }
+    }
+
+    Component {
+        id: boxBlur
+
+        GaussianBlur {
+            source: contentSource
+            radius: root.radius
+            samples: (root.radius * 2)
+            algorithm: GaussianBlur.Box
+        }
+    }
+}
@@ -0,0 +1,236 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2022 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <QtCore/qcommandlineparser.h>
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qmath.h>
+#include <QtCore/qtemporarydir.h>
+#include <QtCore/qtextstream.h>
+#include <QtGui/qguiapplication.h>
+#include <QtGui/qsurfaceformat.h>
+#include <QtQml/qqmlengine.h>
+#include <QtQuick/qquickview.h>
+#include <QtShaderTools/private/qshaderbaker_p.h>
+
+// The large kernel path GaussianBlur used before it paired the texels: one
+// texture fetch for every texel of the kernel. Kept here as the reference.
+static constexpr const char kReferenceVertexShader[] = R"(#version 440
+layout(location = 0) in vec4 qt_Vertex;
+layout(location = 1) in vec2 qt_MultiTexCoord0;
+layout(std140, binding = 0) uniform buf {
+    mat4 qt_Matrix;
+    float qt_Opacity;
+    vec2 dirstep;
+};
+layout(location = 0) out vec2 qt_TexCoord0;
+out gl_PerVertex { vec4 gl_Position; };
+void main() {
+    gl_Position = qt_Matrix * qt_Vertex;
+    qt_TexCoord0 = qt_MultiTexCoord0;
+}
+)";
+
+[[nodiscard]] static QByteArray referenceFragmentShader(const int radius)
+{
+    // Same deviation as GaussianBlur picks for the radius.
+    const qreal deviation = ((qreal(radius) + 1.0) / 3.3333);
+    QByteArray shader = "#version 440\n"
+        "layout(std140, binding = 0) uniform buf {\n"
+        "    mat4 qt_Matrix;\n"
+        "    float qt_Opacity;\n"
+        "    vec2 dirstep;\n"
+        "};\n"
+        "layout(binding = 1) uniform sampler2D source;\n"
+        "layout(location = 0) in vec2 qt_TexCoord0;\n"
+        "layout(location = 0) out vec4 fragColor;\n"
+        "void main() {\n"
+        "    vec4 result = vec4(0.0);\n"_qba;
+    qreal wSum = 0.0;
+    for (int i = -radius; i <= radius; ++i) {
+        const qreal w = qExp(-qreal(i * i) / (2.0 * deviation * deviation));
+        wSum += w;
+        shader += "    result += float("_qba + QByteArray::number(w)
+                  + ") * texture(source, qt_TexCoord0 + dirstep * float("_qba
+                  + QByteArray::number(i) + "));\n"_qba;
+    }
+    shader += "    fragColor = (qt_Opacity / float("_qba + QByteArray::number(wSum) + ")) * result;\n}\n"_qba;
+    return shader;
+}
+
+[[nodiscard]] static QUrl bakeShader(const QByteArray &code, const QShader::Stage stage, const QString &filePath)
+{
+    QShaderBaker baker{};
+    baker.setGeneratedShaders({
+        { QShader::SpirvShader, QShaderVersion(100) },
+        { QShader::GlslShader, QShaderVersion(100, QShaderVersion::GlslEs) },
+        { QShader::GlslShader, QShaderVersion(120) },
+        { QShader::GlslShader, QShaderVersion(150) },
+        { QShader::HlslShader, QShaderVersion(50) },
+        { QShader::MslShader, QShaderVersion(12) }
+    });
+    if (stage == QShader::VertexStage) {
+        baker.setGeneratedShaderVariants({ QShader::StandardShader, QShader::BatchableVertexShader });
+    } else {
+        baker.setGeneratedShaderVariants({ QShader::StandardShader });
+    }
+    baker.setSourceString(code, stage);
+    const QShader shader = baker.bake();
+    if (!shader.isValid()) {
+        qCritical() << "Failed to bake the reference shader:" << baker.errorMessage();
+        return {};
+    }
+    QFile file(filePath);
+    if (!file.open(QFile::WriteOnly) || (file.write(shader.serialized()) < 0)) {
+        qCritical() << "Failed to write" << filePath;
+        return {};
+    }
+    return QUrl::fromLocalFile(filePath);
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication::setApplicationName(u"QtAcrylicMaterial Benchmark"_qs);
+
+    // Frames have to follow each other as fast as they can be rendered.
+    QSurfaceFormat format = QSurfaceFormat::defaultFormat();
+    format.setSwapInterval(0);
+    QSurfaceFormat::setDefaultFormat(format);
+
+    QGuiApplication application(argc, argv);
+
+    static const QStringList allScenarios = {
+        u"pertexel"_qs, u"gaussian"_qs, u"dualkawase"_qs, u"box"_qs
+    };
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(u"Renders every scenario for a fixed number of frames "
+        "and prints the average frame time. Scenarios: "_qs + allScenarios.join(u", "_qs));
+    parser.addHelpOption();
+    const QCommandLineOption scenarioOption(u"scenario"_qs, u"Scenario to run, can be repeated. All of them by default."_qs, u"name"_qs);
+    const QCommandLineOption radiusOption(u"radius"_qs, u"Blur radius."_qs, u"radius"_qs, u"60"_qs);
+    const QCommandLineOption framesOption(u"frames"_qs, u"Measured frames per scenario."_qs, u"count"_qs, u"300"_qs);
+    const QCommandLineOption warmupOption(u"warmup"_qs, u"Frames rendered before measuring."_qs, u"count"_qs, u"30"_qs);
+    const QCommandLineOption widthOption(u"width"_qs, u"Window width."_qs, u"pixels"_qs, u"1280"_qs);
+    const QCommandLineOption heightOption(u"height"_qs, u"Window height."_qs, u"pixels"_qs, u"720"_qs);
+    parser.addOptions({ scenarioOption, radiusOption, framesOption, warmupOption, widthOption, heightOption });
+    parser.process(application);
+
+    QStringList scenarios = parser.values(scenarioOption);
+    if (scenarios.isEmpty()) {
+        scenarios = allScenarios;
+    }
+    for (auto &&scenario : std::as_const(scenarios)) {
+        if (!allScenarios.contains(scenario)) {
+            qCritical() << "Unknown scenario" << scenario;
+            return -1;
+        }
+    }
+    const int radius = qBound(1, parser.value(radiusOption).toInt(), 64);
+    const int frames = qMax(1, parser.value(framesOption).toInt());
+    const int warmup = qMax(0, parser.value(warmupOption).toInt());
+
+    const QTemporaryDir shaderDir{};
+    const QUrl referenceVertexShader = bakeShader(kReferenceVertexShader, QShader::VertexStage,
+                                                  shaderDir.filePath(u"reference.vert.qsb"_qs));
+    const QUrl referenceFragmentShader = bakeShader(referenceFragmentShader(radius), QShader::FragmentStage,
+                                                    shaderDir.filePath(u"reference.frag.qsb"_qs));
+
+    QQuickView view;
+    view.engine()->addImportPath(QCoreApplication::applicationDirPath() + u"/../imports"_qs);
+    view.setResizeMode(QQuickView::SizeRootObjectToView);
+    view.resize(parser.value(widthOption).toInt(), parser.value(heightOption).toInt());
+    view.setInitialProperties({
+        { u"radius"_qs, radius },
+        { u"referenceVertexShader"_qs, referenceVertexShader },
+        { u"referenceFragmentShader"_qs, referenceFragmentShader }
+    });
+    view.setSource(QUrl(u"qrc:/Benchmark/Benchmark.qml"_qs));
+    QObject * const root = view.rootObject();
+    if (!root) {
+        return -1;
+    }
+
+    enum class Phase { Loading, Warmup, Measuring };
+    Phase phase = Phase::Loading;
+    qsizetype current = -1;
+    int frameCount = 0;
+    QElapsedTimer timer{};
+    QTextStream out(stdout);
+
+    const auto nextScenario = [&](){
+        if (++current >= scenarios.size()) {
+            QCoreApplication::quit();
+            return;
+        }
+        phase = Phase::Loading;
+        frameCount = 0;
+        timer.start();
+        root->setProperty("scenario", scenarios.at(current));
+    };
+
+    // Queued to the GUI thread, the threaded render loop emits it on the render thread.
+    QObject::connect(&view, &QQuickWindow::frameSwapped, &application, [&](){
+        if ((current < 0) || (current >= scenarios.size())) {
+            return;
+        }
+        switch (phase) {
+        case Phase::Loading:
+            if (root->property("ready").toBool()) {
+                phase = Phase::Warmup;
+                frameCount = 0;
+            } else if (timer.elapsed() > 30000) {
+                out << scenarios.at(current) << ": not ready after 30 seconds, skipped" << Qt::endl;
+                nextScenario();
+                return;
+            }
+            break;
+        case Phase::Warmup:
+            if (++frameCount >= warmup) {
+                phase = Phase::Measuring;
+                frameCount = 0;
+                timer.start();
+            }
+            break;
+        case Phase::Measuring:
+            if (++frameCount >= frames) {
+                const qreal milliseconds = (qreal(timer.nsecsElapsed()) / 1000000.0 / qreal(frames));
+                out << qSetFieldWidth(12) << Qt::left << scenarios.at(current) << qSetFieldWidth(0)
+                    << QString::number(milliseconds, 'f', 3) << " ms/frame  "
+                    << QString::number(1000.0 / milliseconds, 'f', 1) << " fps" << Qt::endl;
+                nextScenario();
+                return;
+            }
+            break;
+        }
+        view.update();
+    });
+
+    out << "Radius " << radius << ", " << view.width() << 'x' << view.height()
+        << ", " << frames << " frames per scenario" << Qt::endl;
+    view.show();
+    nextScenario();
+
+    return QCoreApplication::exec();
+}
@@ -0,0 +1,204 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2022 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "qgfxacrylicnode_p.h"
+#include "qgfxshaderbuilder_p.h"
+#include <QtCore/qmath.h>
+#include <QtGui/qimage.h>
+#include <QtQuick/qquickwindow.h>
+#include <QtQuick/qsgmaterialshader.h>
+#include <QtQuick/qsgtexture.h>
+#include <QtQuick/private/qquickitem_p.h>
+#include <QtQuick/private/qsgadaptationlayer_p.h>
+#include <QtQuick/private/qsgcontext_p.h>
+#include <cstring>
+
+QT_BEGIN_NAMESPACE
+
+// std140 layout of the uniform block in composite.vert and composite.frag.
+struct QGfxAcrylicUniforms
+{
+    float matrix[16];
+    float opacity;
+    float padding[3];
+    float luminosityColor[4];
+    float tintColor[4];
+    float fallbackColor[4];
+    float noiseScale[2];
+    float noiseOpacity;
+    float fallback;
+    float exclusionColor[4];
+    float saturation;
+};
+// No padding after the last member, the block ends right there.
+static_assert(sizeof(QGfxAcrylicUniforms) == 164);
+
+static inline void qgfx_premultipliedColor(const QColor &color, float *out)
+{
+    // Same conversion as QQuickShaderEffect applies to color properties.
+    const float alpha = color.alphaF();
+    out[0] = (color.redF() * alpha);
+    out[1] = (color.greenF() * alpha);
+    out[2] = (color.blueF() * alpha);
+    out[3] = alpha;
+}
+
+class QGfxAcrylicMaterialShader : public QSGMaterialShader
+{
+public:
+    explicit QGfxAcrylicMaterialShader()
+    {
+        setShader(VertexStage, QGfxShaderBuilder::loadShader(u"composite.vert"_qs, QShader::VertexStage));
+        setShader(FragmentStage, QGfxShaderBuilder::loadShader(u"composite.frag"_qs, QShader::FragmentStage));
+    }
+
+    ~QGfxAcrylicMaterialShader() override = default;
+
+    [[nodiscard]] bool updateUniformData(RenderState &state, QSGMaterial *newMaterial, QSGMaterial *oldMaterial) override
+    {
+        Q_UNUSED(oldMaterial);
+        QByteArray * const buffer = state.uniformData();
+        Q_ASSERT(buffer->size() >= qsizetype(sizeof(QGfxAcrylicUniforms)));
+        auto uniforms = reinterpret_cast<QGfxAcrylicUniforms *>(buffer->data());
+        if (state.isMatrixDirty()) {
+            std::memcpy(uniforms->matrix, state.combinedMatrix().constData(), sizeof(uniforms->matrix));
+        }
+        if (state.isOpacityDirty()) {
+            uniforms->opacity = state.opacity();
+        }
+        const QGfxAcrylicParameters &parameters = static_cast<QGfxAcrylicMaterial *>(newMaterial)->parameters;
+        qgfx_premultipliedColor(parameters.luminosityColor, uniforms->luminosityColor);
+        qgfx_premultipliedColor(parameters.tintColor, uniforms->tintColor);
+        qgfx_premultipliedColor(parameters.fallbackColor, uniforms->fallbackColor);
+        uniforms->noiseScale[0] = parameters.noiseScale.x();
+        uniforms->noiseScale[1] = parameters.noiseScale.y();
+        uniforms->noiseOpacity = float(parameters.noiseOpacity);
+        uniforms->fallback = float(parameters.fallback);
+        qgfx_premultipliedColor(parameters.exclusionColor, uniforms->exclusionColor);
+        uniforms->saturation = float(parameters.saturation);
+        return true;
+    }
+
+    void updateSampledImage(RenderState &state, int binding, QSGTexture **texture, QSGMaterial *newMaterial, QSGMaterial *oldMaterial) override
+    {
+        Q_UNUSED(oldMaterial);
+        const auto material = static_cast<QGfxAcrylicMaterial *>(newMaterial);
+        *texture = ((binding == 1) ? material->source : material->noise);
+        if (*texture) {
+            (*texture)->commitTextureOperations(state.rhi(), state.resourceUpdateBatch());
+        }
+    }
+};
+
+QGfxAcrylicMaterial::QGfxAcrylicMaterial()
+{
+    setFlag(QSGMaterial::Blending);
+}
+
+QGfxAcrylicMaterial::~QGfxAcrylicMaterial() = default;
+
+QSGMaterialType *QGfxAcrylicMaterial::type() const
+{
+    static QSGMaterialType type = {};
+    return &type;
+}
+
+QSGMaterialShader *QGfxAcrylicMaterial::createShader(QSGRendererInterface::RenderMode renderMode) const
+{
+    Q_UNUSED(renderMode);
+    return new QGfxAcrylicMaterialShader;
+}
+
+int QGfxAcrylicMaterial::compare(const QSGMaterial *other) const
+{
+    // Every material has a layer of its own, so two of them are never batched.
+    const auto material = static_cast<const QGfxAcrylicMaterial *>(other);
+    const qint64 key = (source ? source->comparisonKey() : 0);
+    const qint64 otherKey = (material->source ? material->source->comparisonKey() : 0);
+    return ((key == otherKey) ? 0 : ((key < otherKey) ? -1 : 1));
+}
+
+QGfxAcrylicNode::QGfxAcrylicNode(QQuickItem *item)
+    : QSGGeometryNode(), m_item(item), m_geometry(QSGGeometry::defaultAttributes_TexturedPoint2D(), 4)
+{
+    Q_ASSERT(item);
+    if (!item) {
+        return;
+    }
+    setGeometry(&m_geometry);
+    setMaterial(&m_material);
+    setFlag(QSGNode::UsePreprocess);
+
+    QQuickItemPrivate * const itemPrivate = QQuickItemPrivate::get(item);
+    m_layer.reset(itemPrivate->sceneGraphContext()->createLayer(itemPrivate->sceneGraphRenderContext()));
+    m_layer->setLive(true);
+    m_layer->setRecursive(false);
+    m_layer->setHasMipmaps(false);
+    // Same orientation as the default of ShaderEffectSource, composite.frag is
+    // shared with the shader effect.
+    m_layer->setMirrorVertical(true);
+    // Emitted from the render thread, so this is a queued connection.
+    QObject::connect(m_layer.get(), &QSGLayer::updateRequested, item, &QQuickItem::update);
+    m_material.source = m_layer.get();
+
+    const QImage noise(u":/org/wangwenx190/QtAcrylicMaterial/assets/noise_256x256.png"_qs);
+    m_noiseTexture.reset(item->window()->createTextureFromImage(noise));
+    if (m_noiseTexture) {
+        m_noiseTexture->setFiltering(QSGTexture::Nearest);
+        m_noiseTexture->setHorizontalWrapMode(QSGTexture::Repeat);
+        m_noiseTexture->setVerticalWrapMode(QSGTexture::Repeat);
+    }
+    m_material.noise = m_noiseTexture.get();
+}
+
+QGfxAcrylicNode::~QGfxAcrylicNode() = default;
+
+void QGfxAcrylicNode::sync(QQuickItem *blurredSource, const QSizeF &size, const qreal dpr, const QGfxAcrylicParameters &parameters)
+{
+    Q_ASSERT(blurredSource);
+    if (!blurredSource || !m_layer) {
+        return;
+    }
+    // Only the fallback color is visible then, the layer keeps its last content
+    // but doesn't render anything until the blur is shown again.
+    m_idle = (parameters.fallback >= 1.0);
+    m_layer->setItem(m_idle ? nullptr : QQuickItemPrivate::get(blurredSource)->itemNode());
+    m_layer->setRect(QRectF(QPointF(0.0, 0.0), size));
+    m_layer->setSize(QSize(qMax(1, qCeil(size.width() * dpr)), qMax(1, qCeil(size.height() * dpr))));
+    m_layer->setDevicePixelRatio(dpr);
+    QSGGeometry::updateTexturedRectGeometry(&m_geometry, QRectF(QPointF(0.0, 0.0), size), QRectF(0.0, 0.0, 1.0, 1.0));
+    markDirty(QSGNode::DirtyGeometry);
+    m_material.parameters = parameters;
+    markDirty(QSGNode::DirtyMaterial);
+}
+
+void QGfxAcrylicNode::preprocess()
+{
+    // The layer only renders again when the blur below it changed.
+    if (m_layer && !m_idle && m_layer->updateTexture()) {
+        markDirty(QSGNode::DirtyMaterial);
+    }
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,99 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2022 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "qtacrylicmaterial_global.h"
+#include <QtCore/qpointer.h>
+#include <QtGui/qcolor.h>
+#include <QtGui/qvector2d.h>
+#include <QtQuick/qsgnode.h>
+#include <QtQuick/qsgmaterial.h>
+
+QT_BEGIN_NAMESPACE
+
+class QQuickItem;
+class QSGLayer;
+class QSGTexture;
+
+// Everything composite.frag needs besides its textures.
+struct QGfxAcrylicParameters
+{
+    QColor luminosityColor = {};
+    QColor tintColor = {};
+    QColor fallbackColor = {};
+    QVector2D noiseScale = {};
+    qreal noiseOpacity = 0.0;
+    qreal fallback = 1.0;
+    QColor exclusionColor = {};
+    qreal saturation = 1.0;
+};
+
+class QTACRYLICMATERIAL_API QGfxAcrylicMaterial : public QSGMaterial
+{
+    Q_DISABLE_COPY_MOVE(QGfxAcrylicMaterial)
+
+public:
+    explicit QGfxAcrylicMaterial();
+    ~QGfxAcrylicMaterial() override;
+
+    [[nodiscard]] QSGMaterialType *type() const override;
+    [[nodiscard]] QSGMaterialShader *createShader(QSGRendererInterface::RenderMode renderMode) const override;
+    [[nodiscard]] int compare(const QSGMaterial *other) const override;
+
+    QSGTexture *source = nullptr;
+    QSGTexture *noise = nullptr;
+    QGfxAcrylicParameters parameters = {};
+};
+
+// The acrylic recipe as a single scene graph node, used by QuickAcrylicMaterial
+// instead of its composite shader effect in native rendering. The blur item is
+// rendered into a layer owned by the node, the same way a ShaderEffectSource
+// would do it, but without an item of its own.
+class QTACRYLICMATERIAL_API QGfxAcrylicNode : public QSGGeometryNode
+{
+    Q_DISABLE_COPY_MOVE(QGfxAcrylicNode)
+
+public:
+    // Must be created from QQuickItem::updatePaintNode() of the given item,
+    // which also gets updated whenever the blur has new content.
+    explicit QGfxAcrylicNode(QQuickItem *item);
+    ~QGfxAcrylicNode() override;
+
+    // Called from QQuickItem::updatePaintNode(), while the GUI thread is blocked.
+    // The layer is detached from the blur while the fallback color is shown.
+    void sync(QQuickItem *blurredSource, const QSizeF &size, const qreal dpr, const QGfxAcrylicParameters &parameters);
+
+    void preprocess() override;
+
+private:
+    QPointer<QQuickItem> m_item = nullptr;
+    QGfxAcrylicMaterial m_material;
+    QSGGeometry m_geometry;
+    QScopedPointer<QSGLayer> m_layer;
+    QScopedPointer<QSGTexture> m_noiseTexture;
+    bool m_idle = false;
+};
+
+QT_END_NAMESPACE
@@ -0,0 +1,202 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2022 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "qgfxblurpyramid_p.h"
+#include "qgfxshaderbuilder_p.h"
+#include "qgfxsourceproxy_p.h"
+#include <QtCore/qhash.h>
+#include <QtCore/qmath.h>
+#include <QtGui/qvector2d.h>
+#include <QtQuick/qquickwindow.h>
+#include <QtQuick/private/qquickshadereffect_p.h>
+#include <QtQuick/private/qquickitem_p.h>
+
+QT_BEGIN_NAMESPACE
+
+static constexpr const char kSource[] = "source";
+static constexpr const char kTexelStep[] = "texelStep";
+
+// Going below 1/32 of the resolution doesn't save anything worth mentioning.
+static constexpr const int sc_maximumLevel = 5;
+// The kernel used on the chosen level shouldn't get smaller than this, otherwise
+// the upscaling starts to show.
+static constexpr const qreal sc_minimumLevelRadius = 6.0;
+// Variance of the 4x4 box filter downsample.frag applies, in input texels.
+static constexpr const qreal sc_downsampleVariance = (15.0 / 12.0);
+
+using QGfxBlurPyramidRegistry = QHash<QQuickItem *, QWeakPointer<QGfxBlurPyramid>>;
+Q_GLOBAL_STATIC(QGfxBlurPyramidRegistry, g_pyramids)
+
+QGfxBlurPyramid::QGfxBlurPyramid(QQuickItem *source) : QObject(), m_source(source)
+{
+    Q_ASSERT(source);
+    if (!source) {
+        return;
+    }
+    // Not a QObject child of anything in the window, so that it can move to
+    // another window along with the source instead of going away with the old one.
+    m_root.reset(new QQuickItem);
+    const auto sourceProxy = new QGfxSourceProxy(m_root.get());
+    sourceProxy->setInterpolation(QGfxSourceProxy::Interpolation::Linear);
+    sourceProxy->setInput(source);
+    connect(sourceProxy, &QGfxSourceProxy::outputChanged, this, &QGfxBlurPyramid::updateLevels);
+    m_sourceProxy = sourceProxy;
+    connect(source, &QQuickItem::widthChanged, this, &QGfxBlurPyramid::updateLevels);
+    connect(source, &QQuickItem::heightChanged, this, &QGfxBlurPyramid::updateLevels);
+    connect(source, &QQuickItem::windowChanged, this, &QGfxBlurPyramid::rebindWindow);
+    connect(source, &QObject::destroyed, this, [source](){
+        // Another item may be created at the same address later on.
+        g_pyramids()->remove(source);
+    });
+    rebindWindow();
+}
+
+QGfxBlurPyramid::~QGfxBlurPyramid()
+{
+    if (!g_pyramids.isDestroyed() && m_source) {
+        g_pyramids()->remove(m_source);
+    }
+    // Takes the proxy and the levels with it.
+    m_root.reset();
+}
+
+QSharedPointer<QGfxBlurPyramid> QGfxBlurPyramid::acquire(QQuickItem *source)
+{
+    Q_ASSERT(source);
+    if (!source) {
+        return {};
+    }
+    QGfxBlurPyramidRegistry * const registry = g_pyramids();
+    if (const QSharedPointer<QGfxBlurPyramid> existing = registry->value(source).toStrongRef()) {
+        return existing;
+    }
+    const QSharedPointer<QGfxBlurPyramid> pyramid(new QGfxBlurPyramid(source));
+    registry->insert(source, pyramid);
+    return pyramid;
+}
+
+int QGfxBlurPyramid::maximumLevel()
+{
+    return sc_maximumLevel;
+}
+
+int QGfxBlurPyramid::levelForRadius(const qreal radius)
+{
+    int level = 0;
+    while ((level < sc_maximumLevel) && ((radius / qreal(1 << (level + 1))) >= sc_minimumLevelRadius)) {
+        ++level;
+    }
+    return level;
+}
+
+qreal QGfxBlurPyramid::addedVariance(const int level)
+{
+    // Every level applies the box filter in the texels of the previous level.
+    qreal variance = 0.0;
+    for (int i = 1; i <= level; ++i) {
+        const qreal texel = qreal(1 << (i - 1));
+        variance += (sc_downsampleVariance * texel * texel);
+    }
+    return variance;
+}
+
+QQuickItem *QGfxBlurPyramid::source() const
+{
+    return m_source;
+}
+
+QQuickItem *QGfxBlurPyramid::level(const int index)
+{
+    Q_ASSERT(index >= 0);
+    Q_ASSERT(index <= sc_maximumLevel);
+    if ((index <= 0) || !m_source) {
+        return m_source;
+    }
+    const int count = qMin(index, sc_maximumLevel);
+    if (m_levels.size() >= count) {
+        return m_levels.at(count - 1);
+    }
+    const QGfxShaderUrls shaders = QGfxShaderBuilder::staticShaders(u"downsample"_qs);
+    while (m_levels.size() < count) {
+        const auto level = new QQuickShaderEffect(m_root.get());
+        level->setVertexShader(shaders.vertexShader);
+        level->setFragmentShader(shaders.fragmentShader);
+        QQuickItemLayer * const layer = QQuickItemPrivate::get(level)->layer();
+        layer->setSmooth(true);
+        layer->setEnabled(true);
+        level->setVisible(false);
+        level->setBlending(false);
+        m_levels.append(level);
+    }
+    updateLevels();
+    return m_levels.at(count - 1);
+}
+
+QSize QGfxBlurPyramid::levelTextureSize(const int index) const
+{
+    if (!m_source) {
+        return {};
+    }
+    const qreal dpr = (m_window ? m_window->effectiveDevicePixelRatio() : 1.0);
+    const qreal scale = (dpr / qreal(1 << qBound(0, index, sc_maximumLevel)));
+    return QSize(qMax(1, qCeil(m_source->width() * scale)), qMax(1, qCeil(m_source->height() * scale)));
+}
+
+void QGfxBlurPyramid::rebindWindow()
+{
+    if (m_window) {
+        disconnect(m_window, nullptr, this, nullptr);
+    }
+    m_window = (m_source ? m_source->window() : nullptr);
+    // The levels don't need to be anywhere near the source, they only have to be
+    // part of the same scene. Keeping them out of the source itself also keeps
+    // its list of children untouched, and the root item keeps them out of the
+    // list of children of the content item.
+    if (m_root) {
+        m_root->setParentItem(m_window ? m_window->contentItem() : nullptr);
+    }
+    if (m_window) {
+        connect(m_window, &QWindow::screenChanged, this, &QGfxBlurPyramid::updateLevels);
+    }
+    updateLevels();
+}
+
+void QGfxBlurPyramid::updateLevels()
+{
+    for (qsizetype i = 0; i != m_levels.size(); ++i) {
+        QQuickShaderEffect * const level = m_levels.at(i);
+        if (!level) {
+            continue;
+        }
+        level->setSize(m_source ? m_source->size() : QSizeF());
+        QQuickItemPrivate::get(level)->layer()->setTextureSize(levelTextureSize(int(i) + 1));
+        QQuickItem * const input = ((i == 0) ? (m_sourceProxy ? m_sourceProxy->output() : nullptr) : m_levels.at(i - 1).data());
+        const QSize inputSize = levelTextureSize(int(i));
+        level->setProperty(kSource, QVariant::fromValue(input));
+        level->setProperty(kTexelStep, QVector2D((1.0 / inputSize.width()), (1.0 / inputSize.height())));
+    }
+    Q_EMIT levelsChanged();
+}
+
+QT_END_NAMESPACE
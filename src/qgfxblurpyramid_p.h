@@ -0,0 +1,84 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2022 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "qtacrylicmaterial_global.h"
+#include <QtCore/qobject.h>
+#include <QtCore/qpointer.h>
+#include <QtCore/qscopedpointer.h>
+#include <QtCore/qsharedpointer.h>
+#include <QtCore/qsize.h>
+
+QT_BEGIN_NAMESPACE
+
+class QQuickItem;
+class QQuickWindow;
+class QQuickShaderEffect;
+class QGfxSourceProxy;
+
+// Progressively half sized copies of one source item. Blurring a coarse level
+// with a small kernel and scaling the result back up looks the same as blurring
+// the full resolution source with a big kernel, for a fraction of the cost.
+// All the blurs of the same source share one pyramid, whatever radius they use.
+class QTACRYLICMATERIAL_API QGfxBlurPyramid : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(QGfxBlurPyramid)
+
+public:
+    ~QGfxBlurPyramid() override;
+
+    [[nodiscard]] static QSharedPointer<QGfxBlurPyramid> acquire(QQuickItem *source);
+    [[nodiscard]] static int maximumLevel();
+    [[nodiscard]] static int levelForRadius(const qreal radius);
+    // The downsampling blurs a little on its own, in full resolution pixels squared.
+    [[nodiscard]] static qreal addedVariance(const int level);
+
+    [[nodiscard]] QQuickItem *source() const;
+
+    // Level 0 is the source itself, every following level halves the resolution.
+    [[nodiscard]] QQuickItem *level(const int index);
+    [[nodiscard]] QSize levelTextureSize(const int index) const;
+
+Q_SIGNALS:
+    void levelsChanged();
+
+private Q_SLOTS:
+    void rebindWindow();
+    void updateLevels();
+
+private:
+    explicit QGfxBlurPyramid(QQuickItem *source);
+
+private:
+    QPointer<QQuickItem> m_source = nullptr;
+    QPointer<QQuickWindow> m_window = nullptr;
+    // Owns the proxy and the levels, it's the only item put into the window.
+    QScopedPointer<QQuickItem> m_root;
+    QPointer<QGfxSourceProxy> m_sourceProxy = nullptr;
+    QList<QPointer<QQuickShaderEffect>> m_levels = {};
+};
+
+QT_END_NAMESPACE
@@ -0,0 +1,326 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2022 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "qgfxcomputeblurnode_p.h"
+
+#if (QT_VERSION >= QT_VERSION_CHECK(6, 6, 0))
+
+#include "qgfxshaderbuilder_p.h"
+#include <QtCore/qmath.h>
+#include <QtGui/qmatrix4x4.h>
+#include <QtGui/private/qrhi_p.h>
+#include <QtQuick/qquickwindow.h>
+#include <QtQuick/qsgtexture.h>
+#include <QtQuick/qsgtextureprovider.h>
+#include <cstring>
+
+QT_BEGIN_NAMESPACE
+
+// Both must match computeblur.comp.
+static constexpr const int sc_workGroupSize = 128;
+static constexpr const int sc_maximumRadius = 64;
+
+// std140 layout of the uniform block in computeblur.comp.
+struct QGfxComputeBlurUniforms
+{
+    float sourceRect[4];
+    qint32 direction[2];
+    qint32 radius;
+    qint32 padding;
+    float weights[68];
+};
+static_assert(sizeof(QGfxComputeBlurUniforms) == 304);
+
+// std140 layout of the uniform block in computeblur.vert and computeblur.frag.
+static constexpr const quint32 sc_presentUniformsSize = (64 + 16);
+
+QGfxComputeBlurNode::QGfxComputeBlurNode(QQuickWindow *window) : QSGRenderNode(), m_window(window)
+{
+    Q_ASSERT(window);
+}
+
+QGfxComputeBlurNode::~QGfxComputeBlurNode()
+{
+    releaseResources();
+}
+
+int QGfxComputeBlurNode::maximumRadius()
+{
+    return sc_maximumRadius;
+}
+
+void QGfxComputeBlurNode::sync(QSGTextureProvider *provider, const QSizeF &size, const qreal dpr, const int radius, const qreal deviation)
+{
+    m_provider = provider;
+    m_size = size;
+    m_pixelSize = QSize(qMax(1, qCeil(size.width() * dpr)), qMax(1, qCeil(size.height() * dpr)));
+    m_radius = qBound(0, radius, sc_maximumRadius);
+    // One weight per texel, the shared memory makes the extra taps cheap enough
+    // that pairing them up isn't worth it here.
+    m_weights.fill(0.0f);
+    qreal total = 0.0;
+    for (int i = 0; i <= m_radius; ++i) {
+        const qreal weight = ((deviation > 0.0) ? qExp(-qreal(i * i) / (2.0 * deviation * deviation)) : ((i == 0) ? 1.0 : 0.0));
+        m_weights[i] = float(weight);
+        total += ((i == 0) ? weight : (2.0 * weight));
+    }
+    for (int i = 0; i <= m_radius; ++i) {
+        m_weights[i] = float(qreal(m_weights[i]) / total);
+    }
+}
+
+bool QGfxComputeBlurNode::ensureResources(QRhi *rhi, QRhiTexture *input)
+{
+    if (!m_computePipeline) {
+        const QShader computeShader = QGfxShaderBuilder::loadShader(u"computeblur.comp"_qs, QShader::ComputeStage);
+        if (!computeShader.isValid()) {
+            return false;
+        }
+
+        m_sampler.reset(rhi->newSampler(QRhiSampler::Linear, QRhiSampler::Linear, QRhiSampler::None,
+                                        QRhiSampler::ClampToEdge, QRhiSampler::ClampToEdge));
+        m_sampler->create();
+        m_intermediateTexture.reset(rhi->newTexture(QRhiTexture::RGBA8, m_pixelSize, 1, QRhiTexture::UsedWithLoadStore));
+        m_intermediateTexture->create();
+        m_outputTexture.reset(rhi->newTexture(QRhiTexture::RGBA8, m_pixelSize, 1, QRhiTexture::UsedWithLoadStore));
+        m_outputTexture->create();
+        for (auto &&buffer : m_computeUniforms) {
+            buffer.reset(rhi->newBuffer(QRhiBuffer::Dynamic, QRhiBuffer::UniformBuffer, sizeof(QGfxComputeBlurUniforms)));
+            buffer->create();
+        }
+        for (auto &&bindings : m_computeBindings) {
+            bindings.reset(rhi->newShaderResourceBindings());
+        }
+        m_input = nullptr;
+
+        m_vertexBuffer.reset(rhi->newBuffer(QRhiBuffer::Dynamic, QRhiBuffer::VertexBuffer, (16 * sizeof(float))));
+        m_vertexBuffer->create();
+        m_presentUniforms.reset(rhi->newBuffer(QRhiBuffer::Dynamic, QRhiBuffer::UniformBuffer, sc_presentUniformsSize));
+        m_presentUniforms->create();
+        m_presentBindings.reset(rhi->newShaderResourceBindings());
+        m_presentBindings->setBindings({
+            QRhiShaderResourceBinding::uniformBuffer(0, (QRhiShaderResourceBinding::VertexStage | QRhiShaderResourceBinding::FragmentStage), m_presentUniforms.get()),
+            QRhiShaderResourceBinding::sampledTexture(1, QRhiShaderResourceBinding::FragmentStage, m_outputTexture.get(), m_sampler.get())
+        });
+        m_presentBindings->create();
+
+        m_computePipeline.reset(rhi->newComputePipeline());
+        m_computePipeline->setShaderStage({ QRhiShaderStage::Compute, computeShader });
+        // Both directions use the same layout, either set of bindings will do.
+        m_computeBindings[0]->setBindings({
+            QRhiShaderResourceBinding::uniformBuffer(0, QRhiShaderResourceBinding::ComputeStage, m_computeUniforms[0].get()),
+            QRhiShaderResourceBinding::sampledTexture(1, QRhiShaderResourceBinding::ComputeStage, m_intermediateTexture.get(), m_sampler.get()),
+            QRhiShaderResourceBinding::imageStore(2, QRhiShaderResourceBinding::ComputeStage, m_outputTexture.get(), 0)
+        });
+        m_computeBindings[0]->create();
+        m_computePipeline->setShaderResourceBindings(m_computeBindings[0].get());
+        if (!m_computePipeline->create()) {
+            releaseResources();
+            return false;
+        }
+    }
+
+    // Rebuilding a texture in place keeps all the bindings referencing it valid.
+    if (m_outputTexture->pixelSize() != m_pixelSize) {
+        m_intermediateTexture->setPixelSize(m_pixelSize);
+        m_intermediateTexture->create();
+        m_outputTexture->setPixelSize(m_pixelSize);
+        m_outputTexture->create();
+    }
+
+    if (m_input != input) {
+        m_input = input;
+        m_computeBindings[0]->setBindings({
+            QRhiShaderResourceBinding::uniformBuffer(0, QRhiShaderResourceBinding::ComputeStage, m_computeUniforms[0].get()),
+            QRhiShaderResourceBinding::sampledTexture(1, QRhiShaderResourceBinding::ComputeStage, input, m_sampler.get()),
+            QRhiShaderResourceBinding::imageStore(2, QRhiShaderResourceBinding::ComputeStage, m_intermediateTexture.get(), 0)
+        });
+        m_computeBindings[0]->create();
+        m_computeBindings[1]->setBindings({
+            QRhiShaderResourceBinding::uniformBuffer(0, QRhiShaderResourceBinding::ComputeStage, m_computeUniforms[1].get()),
+            QRhiShaderResourceBinding::sampledTexture(1, QRhiShaderResourceBinding::ComputeStage, m_intermediateTexture.get(), m_sampler.get()),
+            QRhiShaderResourceBinding::imageStore(2, QRhiShaderResourceBinding::ComputeStage, m_outputTexture.get(), 0)
+        });
+        m_computeBindings[1]->create();
+    }
+
+    QRhiRenderPassDescriptor * const renderPassDescriptor = renderTarget()->renderPassDescriptor();
+    if (!m_presentPipeline || (m_renderPassDescriptor != renderPassDescriptor)) {
+        const QShader vertexShader = QGfxShaderBuilder::loadShader(u"computeblur.vert"_qs, QShader::VertexStage);
+        const QShader fragmentShader = QGfxShaderBuilder::loadShader(u"computeblur.frag"_qs, QShader::FragmentStage);
+        if (!vertexShader.isValid() || !fragmentShader.isValid()) {
+            return false;
+        }
+        m_renderPassDescriptor = renderPassDescriptor;
+        m_presentPipeline.reset(rhi->newGraphicsPipeline());
+        QRhiGraphicsPipeline::TargetBlend blend = {};
+        blend.enable = true;
+        blend.srcColor = QRhiGraphicsPipeline::One;
+        blend.dstColor = QRhiGraphicsPipeline::OneMinusSrcAlpha;
+        blend.srcAlpha = QRhiGraphicsPipeline::One;
+        blend.dstAlpha = QRhiGraphicsPipeline::OneMinusSrcAlpha;
+        m_presentPipeline->setTargetBlends({ blend });
+        m_presentPipeline->setFlags(QRhiGraphicsPipeline::UsesScissor);
+        m_presentPipeline->setTopology(QRhiGraphicsPipeline::TriangleStrip);
+        m_presentPipeline->setShaderStages({
+            { QRhiShaderStage::Vertex, vertexShader },
+            { QRhiShaderStage::Fragment, fragmentShader }
+        });
+        QRhiVertexInputLayout inputLayout = {};
+        inputLayout.setBindings({ { quint32(4 * sizeof(float)) } });
+        inputLayout.setAttributes({
+            { 0, 0, QRhiVertexInputAttribute::Float2, 0 },
+            { 0, 1, QRhiVertexInputAttribute::Float2, quint32(2 * sizeof(float)) }
+        });
+        m_presentPipeline->setVertexInputLayout(inputLayout);
+        m_presentPipeline->setSampleCount(renderTarget()->sampleCount());
+        m_presentPipeline->setShaderResourceBindings(m_presentBindings.get());
+        m_presentPipeline->setRenderPassDescriptor(renderPassDescriptor);
+        if (!m_presentPipeline->create()) {
+            m_presentPipeline.reset();
+            return false;
+        }
+    }
+    return true;
+}
+
+void QGfxComputeBlurNode::prepare()
+{
+    m_valid = false;
+    QRhi * const rhi = (m_window ? m_window->rhi() : nullptr);
+    QSGTexture * const texture = (m_provider ? m_provider->texture() : nullptr);
+    if (!rhi || !texture || !rhi->isFeatureSupported(QRhi::Compute)) {
+        return;
+    }
+    QRhiResourceUpdateBatch * const updates = rhi->nextResourceUpdateBatch();
+    texture->commitTextureOperations(rhi, updates);
+    QRhiTexture * const input = texture->rhiTexture();
+    if (!input || !ensureResources(rhi, input)) {
+        updates->release();
+        return;
+    }
+
+    const QRectF sourceRect = texture->normalizedTextureSubRect();
+    for (int pass = 0; pass != 2; ++pass) {
+        QGfxComputeBlurUniforms uniforms = {};
+        uniforms.sourceRect[0] = float((pass == 0) ? sourceRect.x() : 0.0);
+        uniforms.sourceRect[1] = float((pass == 0) ? sourceRect.y() : 0.0);
+        uniforms.sourceRect[2] = float((pass == 0) ? sourceRect.width() : 1.0);
+        uniforms.sourceRect[3] = float((pass == 0) ? sourceRect.height() : 1.0);
+        uniforms.direction[0] = ((pass == 0) ? 1 : 0);
+        uniforms.direction[1] = ((pass == 0) ? 0 : 1);
+        uniforms.radius = m_radius;
+        std::memcpy(uniforms.weights, m_weights.data(), sizeof(uniforms.weights));
+        updates->updateDynamicBuffer(m_computeUniforms[pass].get(), 0, sizeof(uniforms), &uniforms);
+    }
+
+    const auto width = float(m_size.width());
+    const auto height = float(m_size.height());
+    const float vertices[16] = {
+        0.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, height, 0.0f, 1.0f,
+        width, 0.0f, 1.0f, 0.0f,
+        width, height, 1.0f, 1.0f
+    };
+    updates->updateDynamicBuffer(m_vertexBuffer.get(), 0, sizeof(vertices), vertices);
+    const QMatrix4x4 mvp = ((*projectionMatrix()) * (*matrix()));
+    const auto opacity = float(inheritedOpacity());
+    updates->updateDynamicBuffer(m_presentUniforms.get(), 0, 64, mvp.constData());
+    updates->updateDynamicBuffer(m_presentUniforms.get(), 64, sizeof(opacity), &opacity);
+
+    // Separate passes, so the backend puts a barrier between writing the
+    // intermediate texture and reading it back.
+    QRhiCommandBuffer * const cb = commandBuffer();
+    for (int pass = 0; pass != 2; ++pass) {
+        const int lineLength = ((pass == 0) ? m_pixelSize.width() : m_pixelSize.height());
+        const int lineCount = ((pass == 0) ? m_pixelSize.height() : m_pixelSize.width());
+        cb->beginComputePass((pass == 0) ? updates : nullptr);
+        cb->setComputePipeline(m_computePipeline.get());
+        cb->setShaderResources(m_computeBindings[pass].get());
+        cb->dispatch(((lineLength + sc_workGroupSize - 1) / sc_workGroupSize), lineCount, 1);
+        cb->endComputePass();
+    }
+    m_valid = true;
+}
+
+void QGfxComputeBlurNode::render(const RenderState *state)
+{
+    if (!m_valid) {
+        return;
+    }
+    QRhiCommandBuffer * const cb = commandBuffer();
+    const QSize targetSize = renderTarget()->pixelSize();
+    cb->setGraphicsPipeline(m_presentPipeline.get());
+    cb->setViewport(QRhiViewport(0, 0, targetSize.width(), targetSize.height()));
+    if (state->scissorEnabled()) {
+        const QRect scissor = state->scissorRect();
+        cb->setScissor(QRhiScissor(scissor.x(), scissor.y(), scissor.width(), scissor.height()));
+    } else {
+        cb->setScissor(QRhiScissor(0, 0, targetSize.width(), targetSize.height()));
+    }
+    cb->setShaderResources(m_presentBindings.get());
+    const QRhiCommandBuffer::VertexInput vertexInput(m_vertexBuffer.get(), 0);
+    cb->setVertexInput(0, 1, &vertexInput);
+    cb->draw(4);
+}
+
+void QGfxComputeBlurNode::releaseResources()
+{
+    m_valid = false;
+    m_input = nullptr;
+    m_renderPassDescriptor = nullptr;
+    m_presentPipeline.reset();
+    m_presentBindings.reset();
+    m_presentUniforms.reset();
+    m_vertexBuffer.reset();
+    m_computePipeline.reset();
+    for (auto &&bindings : m_computeBindings) {
+        bindings.reset();
+    }
+    for (auto &&buffer : m_computeUniforms) {
+        buffer.reset();
+    }
+    m_outputTexture.reset();
+    m_intermediateTexture.reset();
+    m_sampler.reset();
+}
+
+QSGRenderNode::StateFlags QGfxComputeBlurNode::changedStates() const
+{
+    return (BlendState | ScissorState | ViewportState);
+}
+
+QSGRenderNode::RenderingFlags QGfxComputeBlurNode::flags() const
+{
+    return (BoundedRectRendering | NoExternalRendering);
+}
+
+QRectF QGfxComputeBlurNode::rect() const
+{
+    return QRectF(QPointF(0.0, 0.0), m_size);
+}
+
+QT_END_NAMESPACE
+
+#endif
@@ -0,0 +1,97 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2022 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "qtacrylicmaterial_global.h"
+#include <QtCore/qpointer.h>
+#include <QtQuick/qsgrendernode.h>
+#include <array>
+
+#if (QT_VERSION >= QT_VERSION_CHECK(6, 6, 0))
+
+QT_BEGIN_NAMESPACE
+
+class QQuickWindow;
+class QSGTextureProvider;
+class QRhi;
+class QRhiBuffer;
+class QRhiSampler;
+class QRhiTexture;
+class QRhiShaderResourceBindings;
+class QRhiComputePipeline;
+class QRhiGraphicsPipeline;
+class QRhiRenderPassDescriptor;
+
+// Separable gaussian blur running as two compute dispatches, used by
+// QuickGaussianBlur instead of its shader effect passes when the backend
+// supports compute. Only rectangular clips are respected.
+class QTACRYLICMATERIAL_API QGfxComputeBlurNode : public QSGRenderNode
+{
+    Q_DISABLE_COPY_MOVE(QGfxComputeBlurNode)
+
+public:
+    explicit QGfxComputeBlurNode(QQuickWindow *window);
+    ~QGfxComputeBlurNode() override;
+
+    [[nodiscard]] static int maximumRadius();
+
+    // Called from QQuickItem::updatePaintNode(), while the GUI thread is blocked.
+    void sync(QSGTextureProvider *provider, const QSizeF &size, const qreal dpr, const int radius, const qreal deviation);
+
+    void prepare() override;
+    void render(const RenderState *state) override;
+    void releaseResources() override;
+    [[nodiscard]] StateFlags changedStates() const override;
+    [[nodiscard]] RenderingFlags flags() const override;
+    [[nodiscard]] QRectF rect() const override;
+
+private:
+    [[nodiscard]] bool ensureResources(QRhi *rhi, QRhiTexture *input);
+
+private:
+    QPointer<QQuickWindow> m_window = nullptr;
+    QPointer<QSGTextureProvider> m_provider = nullptr;
+    QSizeF m_size = {};
+    QSize m_pixelSize = {};
+    int m_radius = 0;
+    std::array<float, 68> m_weights = {};
+    bool m_valid = false;
+    QRhiTexture *m_input = nullptr;
+    QRhiRenderPassDescriptor *m_renderPassDescriptor = nullptr;
+    QScopedPointer<QRhiSampler> m_sampler;
+    QScopedPointer<QRhiTexture> m_intermediateTexture;
+    QScopedPointer<QRhiTexture> m_outputTexture;
+    std::array<QScopedPointer<QRhiBuffer>, 2> m_computeUniforms = {};
+    std::array<QScopedPointer<QRhiShaderResourceBindings>, 2> m_computeBindings = {};
+    QScopedPointer<QRhiComputePipeline> m_computePipeline;
+    QScopedPointer<QRhiBuffer> m_vertexBuffer;
+    QScopedPointer<QRhiBuffer> m_presentUniforms;
+    QScopedPointer<QRhiShaderResourceBindings> m_presentBindings;
+    QScopedPointer<QRhiGraphicsPipeline> m_presentPipeline;
+};
+
+QT_END_NAMESPACE
+
+#endif
@@ -0,0 +1,278 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2022 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "qgfxincrementalblur_p.h"
+#include <QtCore/qmath.h>
+#include <QtGui/qvector2d.h>
+#include <QtQuick/qquickwindow.h>
+#include <QtQuick/private/qquickwindow_p.h>
+#include <QtQuick/private/qquickshadereffect_p.h>
+#include <QtQuick/private/qquickshadereffectsource_p.h>
+#include <QtQuick/private/qquickanchors_p.h>
+#include <QtQuick/private/qquickitem_p.h>
+
+QT_BEGIN_NAMESPACE
+
+static constexpr const char kSource[] = "source";
+static constexpr const char kDirstep[] = "dirstep";
+
+// Changes which may have moved the item or shrunk it. Where it was before isn't
+// known anymore, so its parent, which covered both places, counts as damaged.
+static constexpr const quint32 sc_geometryChanges = (QQuickItemPrivate::TransformUpdateMask
+    | QQuickItemPrivate::Size | QQuickItemPrivate::ChildrenChanged
+    | QQuickItemPrivate::ParentChanged | QQuickItemPrivate::Clip);
+
+// Snaps the rectangle to whole device pixels, so the patches line up with the
+// texels of the previous output.
+[[nodiscard]] static inline QRectF qgfx_alignedRect(const QRectF &rect, const qreal dpr)
+{
+    const QRect deviceRect = QRectF(rect.topLeft() * dpr, rect.size() * dpr).toAlignedRect();
+    return {QPointF(deviceRect.topLeft()) / dpr, QSizeF(deviceRect.size()) / dpr};
+}
+
+QGfxIncrementalBlur::QGfxIncrementalBlur(QQuickItem *effect) : QObject(), m_effect(effect)
+{
+    Q_ASSERT(effect);
+    if (!effect) {
+        return;
+    }
+
+    m_root.reset(new QQuickItem(effect));
+    const auto rootAnchors = new QQuickAnchors(m_root.get(), m_root.get());
+    rootAnchors->setFill(effect);
+
+    m_accumulator.reset(new QQuickShaderEffectSource(effect));
+    const auto accumulatorAnchors = new QQuickAnchors(m_accumulator.get(), m_accumulator.get());
+    accumulatorAnchors->setFill(effect);
+    m_accumulator->setSmooth(true);
+    m_accumulator->setSourceItem(m_root.get());
+    // The root draws the accumulator itself.
+    m_accumulator->setRecursive(true);
+    m_accumulator->setLive(false);
+    m_accumulator->setHideSource(true);
+    m_accumulator->setVisible(false);
+
+    // The default shaders just draw the source.
+    m_previous.reset(new QQuickShaderEffect(m_root.get()));
+    const auto previousAnchors = new QQuickAnchors(m_previous.get(), m_previous.get());
+    previousAnchors->setFill(m_root.get());
+    m_previous->setProperty(kSource, QVariant::fromValue(m_accumulator.get()));
+    m_previous->setBlending(false);
+
+    // Like the proxy of QGfxSourceProxy, it has no size and only provides its texture.
+    m_patchSource.reset(new QQuickShaderEffectSource(effect));
+    m_patchSource->setSmooth(true);
+    m_patchSource->setLive(false);
+
+    m_horizontalBlur.reset(new QQuickShaderEffect(effect));
+    QQuickItemLayer * const horizontalBlurLayer = QQuickItemPrivate::get(m_horizontalBlur.get())->layer();
+    horizontalBlurLayer->setSmooth(true);
+    horizontalBlurLayer->setEnabled(true);
+    m_horizontalBlur->setVisible(false);
+    m_horizontalBlur->setBlending(false);
+    m_horizontalBlur->setProperty(kSource, QVariant::fromValue(m_patchSource.get()));
+
+    m_verticalBlur.reset(new QQuickShaderEffect(effect));
+    QQuickItemLayer * const verticalBlurLayer = QQuickItemPrivate::get(m_verticalBlur.get())->layer();
+    verticalBlurLayer->setSmooth(true);
+    verticalBlurLayer->setEnabled(true);
+    m_verticalBlur->setVisible(false);
+    m_verticalBlur->setBlending(false);
+    m_verticalBlur->setProperty(kSource, QVariant::fromValue(m_horizontalBlur.get()));
+
+    // Replaces whatever the previous output had there, translucent parts included.
+    m_patch.reset(new QQuickShaderEffect(m_root.get()));
+    m_patch->setProperty(kSource, QVariant::fromValue(m_verticalBlur.get()));
+    m_patch->setBlending(false);
+
+    connect(effect, &QQuickItem::windowChanged, this, &QGfxIncrementalBlur::rebindWindow);
+    rebindWindow();
+}
+
+QGfxIncrementalBlur::~QGfxIncrementalBlur() = default;
+
+void QGfxIncrementalBlur::setSource(QQuickItem *source)
+{
+    if (m_source == source) {
+        return;
+    }
+    m_source = source;
+    m_patchSource->setSourceItem(m_source);
+    invalidate();
+}
+
+void QGfxIncrementalBlur::setMargin(const qreal margin)
+{
+    if (qFuzzyCompare(m_margin, margin)) {
+        return;
+    }
+    m_margin = margin;
+    invalidate();
+}
+
+void QGfxIncrementalBlur::setDevicePixelRatio(const qreal dpr)
+{
+    if (qFuzzyCompare(m_dpr, dpr)) {
+        return;
+    }
+    m_dpr = dpr;
+    invalidate();
+}
+
+QQuickShaderEffect *QGfxIncrementalBlur::horizontalPass() const
+{
+    return m_horizontalBlur.get();
+}
+
+QQuickShaderEffect *QGfxIncrementalBlur::verticalPass() const
+{
+    return m_verticalBlur.get();
+}
+
+QQuickItem *QGfxIncrementalBlur::output() const
+{
+    return m_accumulator.get();
+}
+
+void QGfxIncrementalBlur::invalidate()
+{
+    m_pendingDamage = QRectF(QPointF(0.0, 0.0), m_effect->size());
+    if (m_window) {
+        m_window->update();
+    }
+}
+
+void QGfxIncrementalBlur::rebindWindow()
+{
+    if (m_window) {
+        disconnect(m_window, nullptr, this, nullptr);
+    }
+    m_window = m_effect->window();
+    if (m_window) {
+        // Emitted in the gui thread once the items have been polished, right
+        // before the synchronization picks up their changes.
+        connect(m_window, &QQuickWindow::afterAnimating, this, &QGfxIncrementalBlur::collectDamage);
+    }
+    invalidate();
+}
+
+QRectF QGfxIncrementalBlur::sourceDamage() const
+{
+    if (!m_source || !m_window) {
+        return {};
+    }
+    QRectF damage = {};
+    const QQuickWindowPrivate * const windowPrivate = QQuickWindowPrivate::get(m_window);
+    for (QQuickItem *item = windowPrivate->dirtyItemList; item; item = QQuickItemPrivate::get(item)->nextDirtyItem) {
+        if ((item != m_source) && !m_source->isAncestorOf(item)) {
+            continue;
+        }
+        // The effect may be inside its own source. Its patches change in every
+        // frame they are applied, which would keep damaging the source forever.
+        if ((item == m_effect) || m_effect->isAncestorOf(item)) {
+            continue;
+        }
+        QQuickItem *damagedItem = item;
+        if (QQuickItemPrivate::get(item)->dirtyAttributes & sc_geometryChanges) {
+            if (item == m_source) {
+                return m_source->boundingRect();
+            }
+            damagedItem = item->parentItem();
+        }
+        const QRectF rect = damagedItem->boundingRect().united(damagedItem->childrenRect());
+        damage |= damagedItem->mapRectToItem(m_source, rect);
+    }
+    return damage;
+}
+
+void QGfxIncrementalBlur::collectDamage()
+{
+    QRectF damage = m_pendingDamage;
+    m_pendingDamage = {};
+    if (m_source && (m_source->width() > 0.0) && (m_source->height() > 0.0)) {
+        const QRectF sourceRect = sourceDamage();
+        if (!sourceRect.isEmpty()) {
+            // The source is stretched over the whole effect.
+            const qreal xScale = (m_effect->width() / m_source->width());
+            const qreal yScale = (m_effect->height() / m_source->height());
+            damage |= QRectF(sourceRect.x() * xScale, sourceRect.y() * yScale,
+                             sourceRect.width() * xScale, sourceRect.height() * yScale);
+        }
+    }
+    reblur(damage);
+}
+
+void QGfxIncrementalBlur::reblur(const QRectF &damage)
+{
+    const QRectF bounds = {QPointF(0.0, 0.0), m_effect->size()};
+    if (damage.isEmpty() || bounds.isEmpty() || !m_source) {
+        setReblurredFraction(0.0);
+        return;
+    }
+    // The output changes as far as the kernel reaches around the damage, and the
+    // passes need their input once more that far around the output. Nothing is
+    // added at the edges of the effect, the textures repeat their edges there
+    // just like with the regular passes.
+    const QRectF outputRect = qgfx_alignedRect(damage.adjusted(-m_margin, -m_margin, m_margin, m_margin).intersected(bounds), m_dpr);
+    const QRectF horizontalRect = qgfx_alignedRect(outputRect.adjusted(0.0, -m_margin, 0.0, m_margin).intersected(bounds), m_dpr);
+    const QRectF sourceRect = qgfx_alignedRect(horizontalRect.adjusted(-m_margin, 0.0, m_margin, 0.0).intersected(bounds), m_dpr);
+
+    const qreal xScale = (m_source->width() / bounds.width());
+    const qreal yScale = (m_source->height() / bounds.height());
+    m_patchSource->setSourceRect(QRectF(sourceRect.x() * xScale, sourceRect.y() * yScale,
+                                        sourceRect.width() * xScale, sourceRect.height() * yScale));
+
+    // Every pass covers exactly the area of its input texture, its layer then
+    // keeps the part the next pass needs.
+    m_horizontalBlur->setPosition(sourceRect.topLeft());
+    m_horizontalBlur->setSize(sourceRect.size());
+    m_horizontalBlur->setProperty(kDirstep, QVector2D((1.0 / (sourceRect.width() * m_dpr)), 0.0));
+    QQuickItemPrivate::get(m_horizontalBlur.get())->layer()->setSourceRect(horizontalRect.translated(-sourceRect.topLeft()));
+
+    m_verticalBlur->setPosition(horizontalRect.topLeft());
+    m_verticalBlur->setSize(horizontalRect.size());
+    m_verticalBlur->setProperty(kDirstep, QVector2D(0.0, (1.0 / (horizontalRect.height() * m_dpr))));
+    QQuickItemPrivate::get(m_verticalBlur.get())->layer()->setSourceRect(outputRect.translated(-horizontalRect.topLeft()));
+
+    m_patch->setPosition(outputRect.topLeft());
+    m_patch->setSize(outputRect.size());
+
+    m_patchSource->scheduleUpdate();
+    m_accumulator->scheduleUpdate();
+
+    setReblurredFraction((outputRect.width() * outputRect.height()) / (bounds.width() * bounds.height()));
+    Q_EMIT reblurred();
+}
+
+void QGfxIncrementalBlur::setReblurredFraction(const qreal value)
+{
+    if (qFuzzyCompare(m_reblurredFraction, value)) {
+        return;
+    }
+    m_reblurredFraction = value;
+    Q_EMIT reblurredFractionChanged();
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,108 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2022 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include "qtacrylicmaterial_global.h"
+#include <QtCore/qobject.h>
+#include <QtCore/qpointer.h>
+#include <QtCore/qrect.h>
+
+QT_BEGIN_NAMESPACE
+
+class QQuickItem;
+class QQuickWindow;
+class QQuickShaderEffect;
+class QQuickShaderEffectSource;
+
+// Keeps the previous output of a two pass blur and only blurs again what changed
+// since then. The changes are taken from the items of the source which the scene
+// graph is about to update, every frame right before the synchronization. The
+// damaged area grows by the reach of the kernel: the horizontal pass needs the
+// source that much to the left and to the right, the vertical pass needs the
+// result of the horizontal one that much above and below.
+class QTACRYLICMATERIAL_API QGfxIncrementalBlur : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(QGfxIncrementalBlur)
+
+public:
+    // All the items are created as children of the effect and have its size.
+    explicit QGfxIncrementalBlur(QQuickItem *effect);
+    ~QGfxIncrementalBlur() override;
+
+    [[nodiscard]] QQuickItem *source() const { return m_source; }
+    void setSource(QQuickItem *source);
+
+    // How far the kernel reaches, in the logical pixels of the effect.
+    void setMargin(const qreal margin);
+    void setDevicePixelRatio(const qreal dpr);
+
+    // The passes get their shaders and uniforms like any other pass, except for
+    // the source and the direction, which are handled here.
+    [[nodiscard]] QQuickShaderEffect *horizontalPass() const;
+    [[nodiscard]] QQuickShaderEffect *verticalPass() const;
+    [[nodiscard]] QQuickItem *output() const;
+
+    // Blurs everything again with the next frame.
+    void invalidate();
+
+    // The part of the output blurred in the last frame.
+    [[nodiscard]] qreal reblurredFraction() const { return m_reblurredFraction; }
+
+Q_SIGNALS:
+    void reblurred();
+    void reblurredFractionChanged();
+
+private Q_SLOTS:
+    void rebindWindow();
+    void collectDamage();
+
+private:
+    [[nodiscard]] QRectF sourceDamage() const;
+    void reblur(const QRectF &damage);
+    void setReblurredFraction(const qreal value);
+
+private:
+    QQuickItem *m_effect = nullptr;
+    QPointer<QQuickItem> m_source = nullptr;
+    QPointer<QQuickWindow> m_window = nullptr;
+    qreal m_margin = 0.0;
+    qreal m_dpr = 1.0;
+    // Collected outside of the frames, applied with the next one.
+    QRectF m_pendingDamage = {};
+    qreal m_reblurredFraction = 0.0;
+    // The accumulator draws the root, which holds its own previous content with
+    // the new patch on top.
+    QScopedPointer<QQuickItem> m_root;
+    QScopedPointer<QQuickShaderEffect> m_previous;
+    QScopedPointer<QQuickShaderEffect> m_patch;
+    QScopedPointer<QQuickShaderEffectSource> m_patchSource;
+    QScopedPointer<QQuickShaderEffect> m_horizontalBlur;
+    QScopedPointer<QQuickShaderEffect> m_verticalBlur;
+    QScopedPointer<QQuickShaderEffectSource> m_accumulator;
+};
+
+QT_END_NAMESPACE
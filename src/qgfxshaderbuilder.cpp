@@ -39,15 +39,24 @@
 ****************************************************************************/
 
 #include "qgfxshaderbuilder_p.h"
+#include "qgfxshadercache_p.h"
 #include <QtCore/qdebug.h>
+#include <QtCore/qfile.h>
 #include <QtCore/qmath.h>
 #include <QtCore/qnumeric.h>
-#include <QtCore/qtemporaryfile.h>
+#include <QtCore/qpromise.h>
+#include <QtCore/qthread.h>
+#include <QtCore/qthreadpool.h>
 #include <QtCore/qvarlengtharray.h>
 #include <QtGui/qoffscreensurface.h>
 #include <QtGui/qopenglcontext.h>
 #include <QtGui/qopenglfunctions.h>
+#include <QtQml/qjsvalue.h>
 #include <QtQuick/qquickwindow.h>
+#include <QtConcurrent/qtconcurrentrun.h>
+#if (QT_VERSION >= QT_VERSION_CHECK(6, 5, 0))
+#  include <QtGui/private/qrhi_p.h>
+#endif
 
 #ifndef GL_MAX_VARYING_COMPONENTS
 #  define GL_MAX_VARYING_COMPONENTS (0x8B4B)
@@ -69,87 +78,178 @@
 #  define QT5COMPAT_MAX_BLUR_SAMPLES_VK (32)
 #endif
 
+// GL_MAX_VARYING_VECTORS is at least 8 on OpenGL ES 2.0 and
+// GL_MAX_VARYING_FLOATS is at least 32 on OpenGL 2.0.
+// Must match QGFX_KERNEL_VECTORS in gaussianblur_dynamic.frag.
+static constexpr const int sc_dynamicKernelVectors = 16;
+
+#ifndef QT5COMPAT_MIN_BLUR_SAMPLES_GLES
+#  define QT5COMPAT_MIN_BLUR_SAMPLES_GLES (8)
+#endif
+
+#ifndef QT5COMPAT_MIN_BLUR_SAMPLES_GL
+#  define QT5COMPAT_MIN_BLUR_SAMPLES_GL (16)
+#endif
+
+static inline void initResource()
+{
+    Q_INIT_RESOURCE(qtacrylicmaterial);
+}
+
 QT_BEGIN_NAMESPACE
 
-QGfxShaderBuilder::QGfxShaderBuilder(QObject *parent) : QObject(parent)
+static const QString kShaderResourcePath = u"/org/wangwenx190/QtAcrylicMaterial/shaders/"_qs;
+
+// Everything in here only depends on the graphics API the whole application is
+// using, so it's resolved once and shared by all the builders and effects.
+struct QGfxShaderBackend
 {
+    QSGRendererInterface::GraphicsApi graphicsApi = QSGRendererInterface::Unknown;
     QList<QShaderBaker::GeneratedShader> targets = {};
+    // Written by whichever thread probes the real backend first, read by the
+    // workers baking the kernels.
+    std::atomic_int maxBlurSamples = QT5COMPAT_MAX_BLUR_SAMPLES;
+    std::atomic_bool capabilitiesResolved = false;
+    std::atomic_bool computeSupported = false;
+
+    explicit QGfxShaderBackend();
+
+    // Only vertex shaders can take part in batching, anything else would just be
+    // baked twice for nothing.
+    [[nodiscard]] static QList<QShader::Variant> variants(const QShader::Stage stage)
+    {
+        if (stage == QShader::VertexStage) {
+            return { QShader::StandardShader, QShader::BatchableVertexShader };
+        }
+        return { QShader::StandardShader };
+    }
+};
 
-    const QSGRendererInterface::GraphicsApi graphicsApi = QQuickWindow::graphicsApi();
-    switch (graphicsApi) {
+QGfxShaderBackend::QGfxShaderBackend()
+{
+    const QSGRendererInterface::GraphicsApi api = QQuickWindow::graphicsApi();
+    graphicsApi = api;
+    switch (api) {
     case QSGRendererInterface::Direct3D11:
         targets.append({ QShader::HlslShader, QShaderVersion(50) });
         break;
     case QSGRendererInterface::OpenGL:
+        // Refined below, this one is understood by every OpenGL (ES)
+        // implementation Qt Quick supports.
         targets.append({ QShader::GlslShader, QShaderVersion(100, QShaderVersion::GlslEs) });
-        targets.append({ QShader::GlslShader, QShaderVersion(120) });
-        targets.append({ QShader::GlslShader, QShaderVersion(150) });
         break;
     case QSGRendererInterface::Metal:
         targets.append({ QShader::MslShader, QShaderVersion(12) });
         break;
     case QSGRendererInterface::Vulkan:
         targets.append({ QShader::SpirvShader, QShaderVersion(100) });
+        maxBlurSamples = QT5COMPAT_MAX_BLUR_SAMPLES_VK;
         break;
     default:
         qWarning() << "QGfxShaderBuilder: Unsupported graphics backend. No shaders will be generated.";
         break;
     }
 
-    m_shaderBaker.setGeneratedShaders(targets);
-    m_shaderBaker.setGeneratedShaderVariants({ QShader::StandardShader,
-                                               QShader::BatchableVertexShader });
-
 #if QT_CONFIG(opengl)
-    if (graphicsApi == QSGRendererInterface::OpenGL) {
-        // The following code makes the assumption that an OpenGL context the GUI
-        // thread will get the same capabilities as the render thread's OpenGL
-        // context. Not 100% accurate, but it works...
-        QOpenGLContext context{};
-        if (!context.create()) {
-            qDebug() << "Failed to acquire GL context to resolve capabilities, using defaults..";
-            m_maxBlurSamples = QT5COMPAT_MAX_BLUR_SAMPLES;
-            return;
-        }
+    if (api != QSGRendererInterface::OpenGL) {
+        return;
+    }
+    // Whether the scene graph gets an OpenGL ES or a desktop OpenGL context is
+    // fixed for the whole process, so only the GLSL flavor it can use is baked.
+    // The profile isn't: QQuickWindow::setFormat(), QQuickRenderControl or the
+    // platform (core profiles on macOS) can all override the default format,
+    // so desktop OpenGL keeps both the compatibility and the core version.
+    const bool gles = (QOpenGLContext::openGLModuleType() == QOpenGLContext::LibGLES);
+    if (gles) {
+        targets = { { QShader::GlslShader, QShaderVersion(100, QShaderVersion::GlslEs) } };
+    } else {
+        targets = {
+            { QShader::GlslShader, QShaderVersion(120) },
+            { QShader::GlslShader, QShaderVersion(150) }
+        };
+    }
 
-        QOffscreenSurface surface{};
-        // In very odd cases, we can get incompatible configs here unless we pass the
-        // GL context's format on to the offscreen format.
-        surface.setFormat(context.format());
-        surface.create();
-
-        QOpenGLContext *oldContext = QOpenGLContext::currentContext();
-        QSurface *oldSurface = (oldContext ? oldContext->surface() : nullptr);
-        if (context.makeCurrent(&surface)) {
-            QOpenGLFunctions *gl = context.functions();
-            if (context.isOpenGLES()) {
-                gl->glGetIntegerv(GL_MAX_VARYING_VECTORS, &m_maxBlurSamples);
-            } else if (context.format().majorVersion() >= 3) {
-                int components = 0;
-                gl->glGetIntegerv(GL_MAX_VARYING_COMPONENTS, &components);
-                m_maxBlurSamples = qRound(qreal(components) / 2.0);
-            } else {
-                int floats = 0;
-                gl->glGetIntegerv(GL_MAX_VARYING_FLOATS, &floats);
-                m_maxBlurSamples = qRound(qreal(floats) / 2.0);
-            }
-            if (oldContext && oldSurface) {
-                oldContext->makeCurrent(oldSurface);
-            } else {
-                context.doneCurrent();
-            }
+#  if (QT_VERSION >= QT_VERSION_CHECK(6, 5, 0))
+    // The real limits are queried from the window's QRhi once its scene graph has
+    // been initialized, see QGfxShaderBuilder::resolveCapabilities(). Until then
+    // stay within what the specifications guarantee, so that nothing we bake
+    // early can fail to link.
+    maxBlurSamples = (gles ? QT5COMPAT_MIN_BLUR_SAMPLES_GLES : QT5COMPAT_MIN_BLUR_SAMPLES_GL);
+#  else
+    // Older Qt versions don't expose the vertex output limits through QRhi.
+    // The following code makes the assumption that an OpenGL context the GUI
+    // thread will get the same capabilities as the render thread's OpenGL
+    // context. Not 100% accurate, but it works...
+    QOpenGLContext context{};
+    if (!context.create()) {
+        qDebug() << "Failed to acquire GL context to resolve capabilities, using defaults..";
+        return;
+    }
+
+    QOffscreenSurface surface{};
+    // In very odd cases, we can get incompatible configs here unless we pass the
+    // GL context's format on to the offscreen format.
+    surface.setFormat(context.format());
+    surface.create();
+
+    QOpenGLContext *oldContext = QOpenGLContext::currentContext();
+    QSurface *oldSurface = (oldContext ? oldContext->surface() : nullptr);
+    if (context.makeCurrent(&surface)) {
+        QOpenGLFunctions *gl = context.functions();
+        int samples = 0;
+        if (context.isOpenGLES()) {
+            gl->glGetIntegerv(GL_MAX_VARYING_VECTORS, &samples);
+        } else if (context.format().majorVersion() >= 3) {
+            int components = 0;
+            gl->glGetIntegerv(GL_MAX_VARYING_COMPONENTS, &components);
+            samples = qRound(qreal(components) / 2.0);
         } else {
-            qDebug() << "QGfxShaderBuilder: Failed to acquire GL context to resolve capabilities, using defaults.";
-            m_maxBlurSamples = QT5COMPAT_MAX_BLUR_SAMPLES;
+            int floats = 0;
+            gl->glGetIntegerv(GL_MAX_VARYING_FLOATS, &floats);
+            samples = qRound(qreal(floats) / 2.0);
         }
-    } else
-#endif
-#if QT_CONFIG(vulkan)
-    if (graphicsApi == QSGRendererInterface::Vulkan) {
-        m_maxBlurSamples = QT5COMPAT_MAX_BLUR_SAMPLES_VK;
-    } else
+        maxBlurSamples = samples;
+        capabilitiesResolved = true;
+        if (oldContext && oldSurface) {
+            oldContext->makeCurrent(oldSurface);
+        } else {
+            context.doneCurrent();
+        }
+    } else {
+        qDebug() << "QGfxShaderBuilder: Failed to acquire GL context to resolve capabilities, using defaults.";
+    }
+#  endif
 #endif
-    m_maxBlurSamples = QT5COMPAT_MAX_BLUR_SAMPLES;
+}
+
+Q_GLOBAL_STATIC(QGfxShaderBackend, g_shaderBackend)
+
+// Baking is CPU bound and may take hundreds of milliseconds for the big kernels,
+// keep it away from both the GUI thread and the application's global pool.
+struct QGfxShaderThreadPool : public QThreadPool
+{
+    explicit QGfxShaderThreadPool()
+    {
+        setObjectName(u"QGfxShaderThreadPool"_qs);
+        setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 1));
+    }
+};
+
+Q_GLOBAL_STATIC(QGfxShaderThreadPool, g_shaderThreadPool)
+
+template<typename T>
+[[nodiscard]] static inline QFuture<T> qgfx_finishedFuture(const T &value)
+{
+    QPromise<T> promise{};
+    QFuture<T> future = promise.future();
+    promise.start();
+    promise.addResult(value);
+    promise.finish();
+    return future;
+}
+
+QGfxShaderBuilder::QGfxShaderBuilder(QObject *parent) : QObject(parent)
+{
 }
 
 QGfxShaderBuilder::~QGfxShaderBuilder() = default;
@@ -289,7 +389,8 @@ static inline void qgfx_declareUniforms(QByteArray &shader, const bool alphaOnly
               "    mat4 qt_Matrix;\n"
               "    float qt_Opacity;\n"
               "    float spread;\n"
-              "    vec2 dirstep;\n"_qba;
+              "    vec2 dirstep;\n"
+              "    float dither;\n"_qba;
     if (alphaOnly) {
         shader += "    vec4 color;\n"
                   "    float thickness;\n"_qba;
@@ -297,6 +398,18 @@ static inline void qgfx_declareUniforms(QByteArray &shader, const bool alphaOnly
     shader += "};\n\n"_qba;
 }
 
+// Ordered dithering for the last pass, shared with the static shaders.
+static inline void qgfx_declareDither(QByteArray &shader)
+{
+    static const QByteArray dither = QGfxShaderBuilder::shaderSource(u"dither.glsl"_qs);
+    shader += dither;
+}
+
+static inline void qgfx_applyDither(QByteArray &shader)
+{
+    shader += "    fragColor.rgb += dither * fragColor.a * qgfx_dither(gl_FragCoord.xy);\n"_qba;
+}
+
 [[nodiscard]] static inline QByteArray qgfx_gaussianVertexShader(QGfxGaussSample *p, const int samples, const bool alphaOnly)
 {
     QByteArray shader = {};
@@ -331,7 +444,9 @@ static inline void qgfx_declareUniforms(QByteArray &shader, const bool alphaOnly
     return shader;
 }
 
-[[nodiscard]] static inline QByteArray qgfx_gaussianFragmentShader(QGfxGaussSample *p, const int samples, const bool alphaOnly)
+// An opaque source only has its color channels blurred, the alpha is known.
+// Alpha-only blurs ignore the hint since they only care about the alpha channel.
+[[nodiscard]] static inline QByteArray qgfx_gaussianFragmentShader(QGfxGaussSample *p, const int samples, const bool alphaOnly, const bool opaque)
 {
     QByteArray shader = {};
     shader.reserve(1024);
@@ -343,11 +458,14 @@ static inline void qgfx_declareUniforms(QByteArray &shader, const bool alphaOnly
     shader += "layout(location = 0) out vec4 fragColor;\n"_qba;
 
     qgfx_declareBlur(shader, "in"_qba, p, samples);
+    qgfx_declareDither(shader);
 
     shader += "\nvoid main() {\n"
               "    fragColor = "_qba;
     if (alphaOnly) {
         shader += "mix(vec4(0), color, clamp(("_qba;
+    } else if (opaque) {
+        shader += "vec4(("_qba;
     } else {
         shader += "("_qba;
     }
@@ -365,14 +483,21 @@ static inline void qgfx_declareUniforms(QByteArray &shader, const bool alphaOnly
         shader += ")"_qba;
         if (alphaOnly) {
             shader += ".a"_qba;
+        } else if (opaque) {
+            shader += ".rgb"_qba;
         }
     }
 
     shader += "\n                   )"_qba;
     if (alphaOnly) {
-        shader += "/thickness, 0.0, 1.0))"_qba;
+        shader += "/thickness, 0.0, 1.0))* qt_Opacity;\n"_qba;
+    } else if (opaque) {
+        shader += "* qt_Opacity, qt_Opacity);\n"_qba;
+    } else {
+        shader += "* qt_Opacity;\n"_qba;
     }
-    shader += "* qt_Opacity;\n}"_qba;
+    qgfx_applyDither(shader);
+    shader += "}\n"_qba;
 
     return shader;
 }
@@ -397,7 +522,16 @@ static inline void qgfx_declareUniforms(QByteArray &shader, const bool alphaOnly
     return vertexShader;
 }
 
-[[nodiscard]] static inline QByteArray qgfx_fallbackFragmentShader(const int requestedRadius, const qreal deviation, const bool masked, const bool alphaOnly)
+// Every pair of neighbouring texels is fetched with one sample in between, as
+// the vertex shader based path does. Since the offsets are constants of the
+// fragment stage, it's not limited by the amount of varyings.
+// The mask scales all the offsets of a fragment alike, which shrinks the kernel
+// as a whole. The taps then no longer land exactly between two texels, but the
+// linear filtering still averages whatever lies around them, so the result stays
+// smooth and masked blurs cost the same as unmasked ones.
+// A spread other than one stretches the whole kernel, every second texel would
+// then be skipped or weighted wrongly, so such kernels fetch every texel on its own.
+[[nodiscard]] static inline QByteArray qgfx_linearFragmentShader(const int requestedRadius, const qreal deviation, const bool masked, const bool alphaOnly, const bool opaque, const bool perTexel)
 {
     QByteArray fragShader = "#version 440\n\n"_qba;
 
@@ -407,122 +541,482 @@ static inline void qgfx_declareUniforms(QByteArray &shader, const bool alphaOnly
     if (masked) {
         fragShader += "layout(binding = 2) uniform sampler2D mask;\n"_qba;
     }
-
     fragShader +=
         "layout(location = 0) out vec4 fragColor;\n"
         "layout(location = 0) in vec2 qt_TexCoord0;\n"
+        "\n"_qba;
+    qgfx_declareDither(fragShader);
+    fragShader +=
         "\n"
-        "void main() {\n"_qba;
-    if (alphaOnly) {
-        fragShader += "    float result = 0.0;\n"_qba;
-    } else {
-        fragShader += "    vec4 result = vec4(0);\n"_qba;
-    }
-    fragShader += "    vec2 pixelStep = dirstep * spread;\n"_qba;
+        "void main() {\n"
+        "    vec2 pixelStep = dirstep * spread;\n"_qba;
     if (masked) {
         fragShader += "    pixelStep *= texture(mask, qt_TexCoord0).a;\n"_qba;
     }
 
-    float wSum = 0.0;
-    for (int r = -requestedRadius; r <= requestedRadius; ++r) {
-        float w = qgfx_gaussian(r, deviation);
-        wSum += w;
+    QVarLengthArray<qreal, 130> weights(requestedRadius + 2);
+    qreal wSum = 0.0;
+    for (int i = 0; i <= requestedRadius; ++i) {
+        weights[i] = qgfx_gaussian(i, deviation);
+        wSum += ((i == 0) ? weights[i] : (2.0 * weights[i]));
+    }
+    weights[requestedRadius + 1] = 0.0;
+
+    const bool colorOnly = (opaque && !alphaOnly);
+    const QByteArray component = (alphaOnly ? ".a"_qba : (colorOnly ? ".rgb"_qba : QByteArray()));
+    fragShader += (alphaOnly ? "    float result = float("_qba : (colorOnly ? "    vec3 result = float("_qba : "    vec4 result = float("_qba));
+    fragShader += QByteArray::number(weights[0] / wSum);
+    fragShader += ") * texture(source, qt_TexCoord0)"_qba + component + ";\n"_qba;
+    for (int i = 1; i <= requestedRadius; i += (perTexel ? 1 : 2)) {
+        const qreal w = (perTexel ? weights[i] : (weights[i] + weights[i + 1]));
+        const qreal offset = (perTexel ? qreal(i) : (((i * weights[i]) + ((i + 1) * weights[i + 1])) / w));
         fragShader += "    result += float("_qba;
-        fragShader += QByteArray::number(w);
-        fragShader += ") * texture(source, qt_TexCoord0 + pixelStep * float("_qba;
-        fragShader += QByteArray::number(r);
-        fragShader += "))"_qba;
-        if (alphaOnly) {
-            fragShader += ".a"_qba;
-        }
-        fragShader += ";\n"_qba;
+        fragShader += QByteArray::number(w / wSum);
+        fragShader += ") * (texture(source, qt_TexCoord0 + pixelStep * float("_qba;
+        fragShader += QByteArray::number(offset);
+        fragShader += "))"_qba + component + " + texture(source, qt_TexCoord0 - pixelStep * float("_qba;
+        fragShader += QByteArray::number(offset);
+        fragShader += "))"_qba + component + ");\n"_qba;
     }
-    fragShader += "    const float wSum = float("_qba;
-    fragShader += QByteArray::number(wSum);
-    fragShader += ");\n"
-                  "    fragColor = "_qba;
+    fragShader += "    fragColor = "_qba;
     if (alphaOnly) {
-        fragShader += "mix(vec4(0), color, clamp((result / wSum) / thickness, 0.0, 1.0)) * qt_Opacity;\n"_qba;
+        fragShader += "mix(vec4(0), color, clamp(result / thickness, 0.0, 1.0)) * qt_Opacity;\n"_qba;
+    } else if (colorOnly) {
+        fragShader += "vec4(qt_Opacity * result, qt_Opacity);\n"_qba;
     } else {
-        fragShader += "(qt_Opacity / wSum) * result;\n"_qba;
+        fragShader += "qt_Opacity * result;\n"_qba;
     }
+    qgfx_applyDither(fragShader);
     fragShader += "}\n"_qba;
 
     return fragShader;
 }
 
-QVariantMap QGfxShaderBuilder::gaussianBlur(const QJSValue &parameters)
+[[nodiscard]] static inline QGfxShaderKey qgfx_resolvedKey(const QGfxShaderKey &key)
 {
-    const qreal requestedRadius = qMax(0.0, parameters.property(u"radius"_qs).toNumber());
-    const qreal deviation = parameters.property(u"deviation"_qs).toNumber();
-    const bool masked = parameters.property(u"masked"_qs).toBool();
-    const bool alphaOnly = parameters.property(u"alphaOnly"_qs).toBool();
+    QGfxShaderKey result = key;
+    if (result.maxSamples <= 0) {
+        result.maxSamples = QGfxShaderBuilder::maximumBlurSamples();
+    }
+    return result;
+}
 
+QGfxShaderUrls QGfxShaderBuilder::gaussianBlurShaders(const QGfxShaderKey &requestedKey)
+{
+    const QGfxShaderKey key = qgfx_resolvedKey(requestedKey);
+    QGfxShaderCache * const cache = QGfxShaderCache::instance();
+    if (const auto cached = cache->find(key)) {
+        return cached.value();
+    }
+
+    if (key.dynamicKernel) {
+        const QGfxShaderUrls result = staticShaders(u"gaussianblur_dynamic"_qs);
+        if (result.isValid()) {
+            cache->insert(key, result);
+        }
+        return result;
+    }
+
+    const qreal requestedRadius = qMax(0.0, key.radius);
     const qreal requestedSamples = ((requestedRadius * 2.0) + 1.0);
     const auto samples = qRound(1.0 + (requestedSamples / 2.0));
     const auto radius = qRound(requestedSamples / 4.0);
-    const bool fallback = parameters.property(u"fallback"_qs).toBool();
-
-    QVariantMap result = {};
 
     QByteArray vertexShader = {};
     QByteArray fragmentShader = {};
-    if ((samples > m_maxBlurSamples) || masked || fallback) {
-        fragmentShader = qgfx_fallbackFragmentShader(qRound(requestedRadius), deviation, masked, alphaOnly);
-        vertexShader = qgfx_fallbackVertexShader(alphaOnly);
+    if ((samples > key.maxSamples) || key.masked || key.fallback) {
+        // The plain kernels QuickAcrylicMaterial uses are baked at build time, so
+        // try them first. They hard code the deviation QuickGaussianBlur uses.
+        const qreal expectedDeviation = ((requestedRadius + 1.0) / 3.3333);
+        if (!key.masked && !key.alphaOnly && !key.fallback
+            && qFuzzyCompare(requestedRadius, qreal(qRound(requestedRadius)))
+            && qFuzzyCompare(key.deviation, expectedDeviation)) {
+            const QString suffix = (key.opaque ? u"_opaque"_qs : QString());
+            QGfxShaderUrls prebaked = {};
+            prebaked.vertexShader = prebakedShader(u"gaussianblur.vert.qsb"_qs);
+            prebaked.fragmentShader = prebakedShader(u"gaussianblur_r%1%2.frag.qsb"_qs.arg(qRound(requestedRadius)).arg(suffix));
+            if (!prebaked.vertexShader.isEmpty() && !prebaked.fragmentShader.isEmpty()) {
+                cache->insert(key, prebaked);
+                return prebaked;
+            }
+        }
+        fragmentShader = qgfx_linearFragmentShader(qRound(requestedRadius), key.deviation, key.masked, key.alphaOnly, key.opaque, key.fallback);
+        vertexShader = qgfx_fallbackVertexShader(key.alphaOnly);
     } else {
         QVarLengthArray<QGfxGaussSample, 64> p(samples);
-        qgfx_buildGaussSamplePoints(p.data(), samples, radius, deviation);
+        qgfx_buildGaussSamplePoints(p.data(), samples, radius, key.deviation);
 
-        fragmentShader = qgfx_gaussianFragmentShader(p.data(), samples, alphaOnly);
-        vertexShader = qgfx_gaussianVertexShader(p.data(), samples, alphaOnly);
+        fragmentShader = qgfx_gaussianFragmentShader(p.data(), samples, key.alphaOnly, key.opaque);
+        vertexShader = qgfx_gaussianVertexShader(p.data(), samples, key.alphaOnly);
     }
 
-    result[u"fragmentShader"_qs] = buildFragmentShader(fragmentShader);
-    result[u"vertexShader"_qs] = buildVertexShader(vertexShader);
+    QGfxShaderUrls result = {};
+    result.vertexShader = bakeShader(vertexShader, QShader::VertexStage);
+    result.fragmentShader = bakeShader(fragmentShader, QShader::FragmentStage);
+    if (result.isValid()) {
+        cache->insert(key, result);
+    }
     return result;
 }
 
-QUrl QGfxShaderBuilder::buildFragmentShader(const QByteArray &code)
+QUrl QGfxShaderBuilder::fragmentShader(const QGfxShaderKey &key, const std::function<QByteArray()> &generator)
+{
+    Q_ASSERT(generator);
+    if (!generator) {
+        return {};
+    }
+    QGfxShaderCache * const cache = QGfxShaderCache::instance();
+    if (const auto cached = cache->find(key)) {
+        return cached.value().fragmentShader;
+    }
+    QGfxShaderUrls result = {};
+    result.fragmentShader = bakeShader(generator(), QShader::FragmentStage);
+    if (!result.fragmentShader.isEmpty()) {
+        cache->insert(key, result);
+    }
+    return result.fragmentShader;
+}
+
+QFuture<QGfxShaderUrls> QGfxShaderBuilder::gaussianBlurShadersAsync(const QGfxShaderKey &requestedKey)
+{
+    // Resolving the key also makes sure the backend has been set up in the GUI
+    // thread, older Qt versions need an OpenGL context for that.
+    const QGfxShaderKey key = qgfx_resolvedKey(requestedKey);
+    if (const auto cached = QGfxShaderCache::instance()->find(key)) {
+        return qgfx_finishedFuture(cached.value());
+    }
+    return QtConcurrent::run(g_shaderThreadPool(), [key](){ return gaussianBlurShaders(key); });
+}
+
+QFuture<QUrl> QGfxShaderBuilder::fragmentShaderAsync(const QGfxShaderKey &key, const std::function<QByteArray()> &generator)
+{
+    Q_ASSERT(generator);
+    if (!generator) {
+        return qgfx_finishedFuture(QUrl());
+    }
+    if (const auto cached = QGfxShaderCache::instance()->find(key)) {
+        return qgfx_finishedFuture(cached.value().fragmentShader);
+    }
+    // The backend has to be set up in the GUI thread, older Qt versions need an
+    // OpenGL context for that.
+    (void)g_shaderBackend();
+    return QtConcurrent::run(g_shaderThreadPool(), [key, generator](){ return fragmentShader(key, generator); });
+}
+
+QSGRendererInterface::GraphicsApi QGfxShaderBuilder::graphicsApi()
+{
+    return g_shaderBackend()->graphicsApi;
+}
+
+int QGfxShaderBuilder::maximumBlurSamples()
+{
+    return g_shaderBackend()->maxBlurSamples;
+}
+
+int QGfxShaderBuilder::maximumDynamicBlurRadius()
+{
+    // Every vector covers four texels on each side of the center.
+    return (sc_dynamicKernelVectors * 4);
+}
+
+QGfxGaussianKernel QGfxShaderBuilder::linearGaussianKernel(const int radius, const qreal deviation)
+{
+    Q_ASSERT(radius >= 0);
+    Q_ASSERT(radius <= maximumDynamicBlurRadius());
+    QGfxGaussianKernel kernel = {};
+    kernel.vectors.fill(QVector4D(), sc_dynamicKernelVectors);
+    if ((radius <= 0) || (radius > maximumDynamicBlurRadius()) || (deviation <= 0.0)) {
+        return kernel;
+    }
+
+    QVarLengthArray<qreal, 66> weights(radius + 2);
+    qreal wSum = 0.0;
+    for (int i = 0; i <= radius; ++i) {
+        weights[i] = qgfx_gaussian(i, deviation);
+        wSum += ((i == 0) ? weights[i] : (2.0 * weights[i]));
+    }
+    weights[radius + 1] = 0.0;
+    kernel.centerWeight = (weights[0] / wSum);
+
+    // Same trick as the generated shaders: one sample between two texels gets
+    // both of them through linear interpolation.
+    for (int i = 1; i <= radius; i += 2) {
+        const qreal w = (weights[i] + weights[i + 1]);
+        const qreal offset = ((w > 0.0) ? (((i * weights[i]) + ((i + 1) * weights[i + 1])) / w) : qreal(i));
+        const int tap = kernel.tapCount++;
+        QVector4D &vector = kernel.vectors[tap / 2];
+        if ((tap % 2) == 0) {
+            vector.setX(offset);
+            vector.setY(w / wSum);
+        } else {
+            vector.setZ(offset);
+            vector.setW(w / wSum);
+        }
+    }
+    return kernel;
+}
+
+void QGfxShaderBuilder::resolveCapabilities(QQuickWindow *window)
+{
+    Q_ASSERT(window);
+    if (!window) {
+        return;
+    }
+    QGfxShaderBackend * const backend = g_shaderBackend();
+    if (backend->capabilitiesResolved) {
+        return;
+    }
+#if (QT_VERSION >= QT_VERSION_CHECK(6, 5, 0))
+#  if (QT_VERSION >= QT_VERSION_CHECK(6, 6, 0))
+    QRhi * const rhi = window->rhi();
+#  else
+    QSGRendererInterface * const rif = window->rendererInterface();
+    QRhi * const rhi = (rif ? static_cast<QRhi *>(rif->getResource(window, QSGRendererInterface::RhiResource)) : nullptr);
+#  endif
+    if (!rhi) {
+        return; // The scene graph has not been initialized yet.
+    }
+    // Every sample occupies one vec2 output of the vertex stage.
+    int samples = rhi->resourceLimit(QRhi::MaxVertexOutputs);
+#  if QT_CONFIG(opengl)
+    // Desktop OpenGL drivers pack two of them into one location.
+    if ((rhi->backend() == QRhi::OpenGLES2) && (QOpenGLContext::openGLModuleType() != QOpenGLContext::LibGLES)) {
+        samples *= 2;
+    }
+#  endif
+    if (samples > 0) {
+        backend->maxBlurSamples = samples;
+    }
+    backend->computeSupported = rhi->isFeatureSupported(QRhi::Compute);
+    backend->capabilitiesResolved = true;
+#endif
+}
+
+bool QGfxShaderBuilder::isComputeSupported()
 {
-    m_fragmentShader.reset(new QTemporaryFile(this));
-    m_fragmentShader->setAutoRemove(false); // We need a permanent file, so disable automatic deletion.
+    return g_shaderBackend()->computeSupported;
+}
 
-    return buildShader(code, QShader::FragmentStage, m_fragmentShader.get());
+bool QGfxShaderBuilder::hasResolvedCapabilities()
+{
+    return g_shaderBackend()->capabilitiesResolved;
+}
+
+QShader QGfxShaderBuilder::loadShader(const QString &fileName, const QShader::Stage stage)
+{
+    initResource();
+    QFile prebakedFile(u':' + kShaderResourcePath + fileName + u".qsb"_qs);
+    if (prebakedFile.open(QFile::ReadOnly)) {
+        return QShader::fromSerialized(prebakedFile.readAll());
+    }
+
+    const QGfxShaderBackend * const backend = g_shaderBackend();
+    QList<QShaderBaker::GeneratedShader> targets = backend->targets;
+    if (stage == QShader::ComputeStage) {
+        // Compute shaders need at least GLSL 430 or GLSL ES 310, which replaces
+        // all the GLSL versions of the other stages.
+        targets.clear();
+        for (auto &&target : std::as_const(backend->targets)) {
+            QShaderBaker::GeneratedShader computeTarget = target;
+            if (target.first == QShader::GlslShader) {
+                const bool gles = target.second.flags().testFlag(QShaderVersion::GlslEs);
+                computeTarget.second = (gles ? QShaderVersion(310, QShaderVersion::GlslEs) : QShaderVersion(430));
+            }
+            if (!targets.contains(computeTarget)) {
+                targets.append(computeTarget);
+            }
+        }
+    }
+    // Materials can end up in merged batches, which need the batchable variant.
+    const QList<QShader::Variant> variants = QGfxShaderBackend::variants(stage);
+    const QByteArray code = shaderSource(fileName);
+    QGfxShaderCache * const cache = QGfxShaderCache::instance();
+    const QByteArray cacheKey = QGfxShaderCache::cacheKey(code, stage, targets, variants, backend->graphicsApi);
+    QShader shader = cache->load(cacheKey);
+    if (shader.isValid()) {
+        return shader;
+    }
+    QShaderBaker baker{};
+    baker.setGeneratedShaders(targets);
+    baker.setGeneratedShaderVariants(variants);
+    baker.setSourceString(code, stage);
+    shader = baker.bake();
+    if (!shader.isValid()) {
+        qWarning() << "QGfxShaderBuilder: Failed to compile shader" << fileName << ":" << baker.errorMessage();
+        return {};
+    }
+    cache->store(cacheKey, shader);
+    return shader;
+}
+
+QVariantMap QGfxShaderBuilder::gaussianBlur(const QJSValue &parameters)
+{
+    QGfxShaderKey key = {};
+    key.radius = parameters.property(u"radius"_qs).toNumber();
+    key.deviation = parameters.property(u"deviation"_qs).toNumber();
+    key.masked = parameters.property(u"masked"_qs).toBool();
+    key.alphaOnly = parameters.property(u"alphaOnly"_qs).toBool();
+    key.fallback = parameters.property(u"fallback"_qs).toBool();
+    key.opaque = parameters.property(u"opaque"_qs).toBool();
+    key.backend = graphicsApi();
+
+    const QGfxShaderUrls shaders = gaussianBlurShaders(key);
+
+    QVariantMap result = {};
+    result[u"fragmentShader"_qs] = shaders.fragmentShader;
+    result[u"vertexShader"_qs] = shaders.vertexShader;
+    return result;
+}
+
+QUrl QGfxShaderBuilder::buildFragmentShader(const QByteArray &code)
+{
+    return bakeShader(code, QShader::FragmentStage);
 }
 
 QUrl QGfxShaderBuilder::buildVertexShader(const QByteArray &code)
 {
-    m_vertexShader.reset(new QTemporaryFile(this));
-    m_vertexShader->setAutoRemove(false); // We need a permanent file, so disable automatic deletion.
+    return bakeShader(code, QShader::VertexStage);
+}
 
-    return buildShader(code, QShader::VertexStage, m_vertexShader.get());
+QVariantMap QGfxShaderBuilder::cacheStatistics() const
+{
+    const QGfxShaderCache * const cache = QGfxShaderCache::instance();
+    QVariantMap result = {};
+    result[u"enabled"_qs] = cache->isEnabled();
+    result[u"directory"_qs] = cache->directory();
+    result[u"hits"_qs] = cache->hitCount();
+    result[u"misses"_qs] = cache->missCount();
+    result[u"memoryHits"_qs] = cache->memoryHitCount();
+    result[u"avoidedRebuilds"_qs] = cache->avoidedRebuildCount();
+    result[u"size"_qs] = cache->size();
+    result[u"maximumSize"_qs] = cache->maximumSize();
+    return result;
+}
+
+QGfxShaderUrls QGfxShaderBuilder::staticShaders(const QString &baseName, const QString &fragmentBaseName)
+{
+    const QString fragmentName = (fragmentBaseName.isEmpty() ? baseName : fragmentBaseName);
+    QGfxShaderUrls result = {};
+    result.vertexShader = prebakedShader(baseName + u".vert.qsb"_qs);
+    result.fragmentShader = prebakedShader(fragmentName + u".frag.qsb"_qs);
+    if (result.vertexShader.isEmpty() || result.fragmentShader.isEmpty()) {
+        // Baked only once per process, bakeShader() remembers the results.
+        result.vertexShader = bakeShader(shaderSource(baseName + u".vert"_qs), QShader::VertexStage);
+        result.fragmentShader = bakeShader(shaderSource(fragmentName + u".frag"_qs), QShader::FragmentStage);
+    }
+    return result;
 }
 
-QUrl QGfxShaderBuilder::buildShader(const QByteArray &code,
-                                    const QShader::Stage stage,
-                                    QTemporaryFile *output)
+QFuture<QList<QGfxShaderUrls>> QGfxShaderBuilder::staticShadersAsync(const QString &baseName, const QStringList &fragmentBaseNames)
 {
-    if (!output->open()) {
-        qWarning() << "QGfxShaderBuilder: Failed to create temporary files";
+    QList<QGfxShaderUrls> prebaked = {};
+    for (auto &&fragmentBaseName : std::as_const(fragmentBaseNames)) {
+        QGfxShaderUrls urls = {};
+        urls.vertexShader = prebakedShader(baseName + u".vert.qsb"_qs);
+        urls.fragmentShader = prebakedShader(fragmentBaseName + u".frag.qsb"_qs);
+        if (!urls.isValid()) {
+            prebaked.clear();
+            break;
+        }
+        prebaked.append(urls);
+    }
+    if (!prebaked.isEmpty()) {
+        return qgfx_finishedFuture(prebaked);
+    }
+    // The backend has to be set up in the GUI thread, older Qt versions need an
+    // OpenGL context for that.
+    (void)g_shaderBackend();
+    return QtConcurrent::run(g_shaderThreadPool(), [baseName, fragmentBaseNames](){
+        QList<QGfxShaderUrls> result = {};
+        for (auto &&fragmentBaseName : std::as_const(fragmentBaseNames)) {
+            result.append(staticShaders(baseName, fragmentBaseName));
+        }
+        return result;
+    });
+}
+
+QUrl QGfxShaderBuilder::prebakedShader(const QString &fileName)
+{
+    initResource();
+    const QString path = kShaderResourcePath + fileName;
+    if (!QFile::exists(u':' + path)) {
         return {};
     }
+    return QUrl(u"qrc:"_qs + path);
+}
 
-    m_shaderBaker.setSourceString(code, stage, output->fileName());
-    const QShader compiledShader = m_shaderBaker.bake();
-    if (!compiledShader.isValid()) {
-        output->close();
-        qWarning() << "QGfxShaderBuilder: Failed to compile shader for stage "
-                   << stage << ": "
-                   << m_shaderBaker.errorMessage()
-                   << QString::fromUtf8(code).replace(QChar(u'\n'), QChar(QChar::LineFeed));
+QByteArray QGfxShaderBuilder::shaderSource(const QString &fileName, const QByteArrayList &defines)
+{
+    initResource();
+    QFile file(u':' + kShaderResourcePath + fileName);
+    if (!file.open(QFile::ReadOnly | QFile::Text)) {
+        qWarning() << "QGfxShaderBuilder: Failed to read shader source" << file.fileName();
         return {};
     }
+    QByteArray source = file.readAll();
+    file.close();
+    // qsb doesn't resolve includes, the shared snippets are pasted in place.
+    // src/CMakeLists.txt does the same for the prebaked shaders.
+    static constexpr const char kIncludeDirective[] = "#include \"";
+    qsizetype includeIndex = source.indexOf(kIncludeDirective);
+    while (includeIndex >= 0) {
+        const qsizetype nameIndex = (includeIndex + qsizetype(sizeof(kIncludeDirective)) - 1);
+        const qsizetype nameEnd = source.indexOf('"', nameIndex);
+        if (nameEnd < 0) {
+            break;
+        }
+        const QByteArray included = shaderSource(QString::fromLatin1(source.sliced(nameIndex, (nameEnd - nameIndex))));
+        source.replace(includeIndex, ((nameEnd + 1) - includeIndex), included);
+        includeIndex = source.indexOf(kIncludeDirective, (includeIndex + included.size()));
+    }
+    if (defines.isEmpty()) {
+        return source;
+    }
+    QByteArray header = {};
+    for (auto &&define : std::as_const(defines)) {
+        header += "#define "_qba + define + '\n';
+    }
+    // The version directive has to come first, so the definitions go right after it.
+    const qsizetype versionIndex = source.indexOf("#version"_qba);
+    const qsizetype insertIndex = ((versionIndex < 0) ? 0 : (source.indexOf('\n', versionIndex) + 1));
+    source.insert(insertIndex, header);
+    return source;
+}
+
+QUrl QGfxShaderBuilder::bakeShader(const QByteArray &code, const QShader::Stage stage)
+{
+    const QGfxShaderBackend * const backend = g_shaderBackend();
+    QGfxShaderCache * const cache = QGfxShaderCache::instance();
+    const QList<QShader::Variant> variants = QGfxShaderBackend::variants(stage);
+    const QByteArray cacheKey = QGfxShaderCache::cacheKey(code, stage, backend->targets, variants, backend->graphicsApi);
+
+    // Identical sources are only ever baked once per process.
+    const QUrl bakedUrl = cache->findBaked(cacheKey);
+    if (!bakedUrl.isEmpty()) {
+        return bakedUrl;
+    }
 
-    output->write(compiledShader.serialized());
-    output->close();
+    QShader compiledShader = cache->load(cacheKey);
+    if (!compiledShader.isValid()) {
+        // QShaderBaker is not thread-safe, but it's cheap to create, so use a
+        // local one instead of sharing a single instance between everyone.
+        QShaderBaker baker{};
+        baker.setGeneratedShaders(backend->targets);
+        baker.setGeneratedShaderVariants(variants);
+        baker.setSourceString(code, stage);
+        compiledShader = baker.bake();
+        if (!compiledShader.isValid()) {
+            qWarning() << "QGfxShaderBuilder: Failed to compile shader for stage "
+                       << stage << ": "
+                       << baker.errorMessage()
+                       << QString::fromUtf8(code).replace(QChar(u'\n'), QChar(QChar::LineFeed));
+            return {};
+        }
+        cache->store(cacheKey, compiledShader);
+    }
 
-    return QUrl::fromLocalFile(output->fileName());
+    const QGfxShaderRecipe recipe = { code, stage, backend->targets, variants, backend->graphicsApi };
+    return cache->insertBaked(cacheKey, compiledShader.serialized(), recipe);
 }
 
 QT_END_NAMESPACE
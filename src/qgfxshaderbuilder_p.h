@@ -41,17 +41,31 @@
 #pragma once
 
 #include "qtacrylicmaterial_global.h"
+#include "qgfxshadercache_p.h"
 #include <QtCore/qobject.h>
+#include <QtCore/qfuture.h>
 #include <QtCore/qmap.h>
+#include <QtCore/qstringlist.h>
 #include <QtCore/qurl.h>
+#include <QtGui/qvector4d.h>
 #include <QtShaderTools/private/qshaderbaker_p.h>
+#include <QtQuick/qsgrendererinterface.h>
 #include <QtQml/qqml.h>
 #include <QtQml/qqmlregistration.h>
+#include <functional>
 
 QT_BEGIN_NAMESPACE
 
 class QJSValue;
-class QTemporaryFile;
+class QQuickWindow;
+
+struct QGfxGaussianKernel
+{
+    qreal centerWeight = 1.0;
+    int tapCount = 0;
+    // Two linearly interpolated taps per vector, as (offset, weight) pairs.
+    QList<QVector4D> vectors = {};
+};
 
 class QTACRYLICMATERIAL_API QGfxShaderBuilder : public QObject
 {
@@ -63,20 +77,42 @@ public:
     explicit QGfxShaderBuilder(QObject *parent = nullptr);
     ~QGfxShaderBuilder() override;
 
+    // Thread-safe and shared by the whole process, the effects use these directly.
+    [[nodiscard]] static QGfxShaderUrls gaussianBlurShaders(const QGfxShaderKey &key);
+    [[nodiscard]] static QUrl fragmentShader(const QGfxShaderKey &key, const std::function<QByteArray()> &generator);
+    // Same as above, but the baking runs in a worker thread. Cache hits are returned
+    // as already finished futures, so callers can apply them without waiting.
+    [[nodiscard]] static QFuture<QGfxShaderUrls> gaussianBlurShadersAsync(const QGfxShaderKey &key);
+    [[nodiscard]] static QFuture<QUrl> fragmentShaderAsync(const QGfxShaderKey &key, const std::function<QByteArray()> &generator);
+    [[nodiscard]] static QUrl bakeShader(const QByteArray &code, const QShader::Stage stage);
+    [[nodiscard]] static QUrl prebakedShader(const QString &fileName);
+    // Shaders without any parameters, shipped as "<baseName>.vert" and "<baseName>.frag".
+    // A vertex shader can be shared by several fragment shaders through fragmentBaseName.
+    [[nodiscard]] static QGfxShaderUrls staticShaders(const QString &baseName, const QString &fragmentBaseName = {});
+    // Same as above for several fragment shaders at once, in the given order. Bakes
+    // in a worker thread if the shaders haven't been prebaked.
+    [[nodiscard]] static QFuture<QList<QGfxShaderUrls>> staticShadersAsync(const QString &baseName, const QStringList &fragmentBaseNames);
+    [[nodiscard]] static QByteArray shaderSource(const QString &fileName, const QByteArrayList &defines = {});
+    // For code talking to QRhi directly, which needs the QShader itself rather than an URL.
+    [[nodiscard]] static QShader loadShader(const QString &fileName, const QShader::Stage stage);
+    [[nodiscard]] static QSGRendererInterface::GraphicsApi graphicsApi();
+    [[nodiscard]] static int maximumBlurSamples();
+    [[nodiscard]] static int maximumDynamicBlurRadius();
+    [[nodiscard]] static QGfxGaussianKernel linearGaussianKernel(const int radius, const qreal deviation);
+    // Only known for sure after resolveCapabilities() succeeded, false until then.
+    [[nodiscard]] static bool isComputeSupported();
+    // Whether the limits above are the real ones rather than the guaranteed minimum.
+    [[nodiscard]] static bool hasResolvedCapabilities();
+    // Queries the real limits from the window's QRhi, only the first call which
+    // finds an initialized scene graph does anything. Safe to call from the
+    // render thread.
+    static void resolveCapabilities(QQuickWindow *window);
+
 public Q_SLOTS:
     [[nodiscard]] QVariantMap gaussianBlur(const QJSValue &parameters);
     [[nodiscard]] QUrl buildVertexShader(const QByteArray &code);
     [[nodiscard]] QUrl buildFragmentShader(const QByteArray &code);
-
-private:
-    [[nodiscard]] QUrl buildShader(const QByteArray &code, const QShader::Stage stage, QTemporaryFile *output);
-
-private:
-    int m_maxBlurSamples = 0;
-    QShaderBaker m_shaderBaker = {};
-
-    QScopedPointer<QTemporaryFile> m_fragmentShader;
-    QScopedPointer<QTemporaryFile> m_vertexShader;
+    [[nodiscard]] QVariantMap cacheStatistics() const;
 };
 
 QT_END_NAMESPACE
@@ -0,0 +1,535 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2022 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "qgfxshadercache_p.h"
+#include <QtCore/qcryptographichash.h>
+#include <QtCore/qdatetime.h>
+#include <QtCore/qdebug.h>
+#include <QtCore/qdir.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qsavefile.h>
+#include <QtCore/qstandardpaths.h>
+#include <QtCore/private/qabstractfileengine_p.h>
+#include <cstring>
+#include <limits>
+
+QT_BEGIN_NAMESPACE
+
+static constexpr const qint64 sc_defaultMaximumSize = (32 * 1024 * 1024); // 32 MiB
+static constexpr const char kDisableEnvVar[] = "QTACRYLICMATERIAL_DISABLE_SHADER_CACHE";
+static constexpr const char kMaximumSizeEnvVar[] = "QTACRYLICMATERIAL_SHADER_CACHE_MAX_SIZE";
+static const QString kFileSuffix = u".qsb"_qs;
+static const QStringList kNameFilters = { u"*.qsb"_qs };
+static const QString kBakedShaderPath = u":/org/wangwenx190/QtAcrylicMaterial/baked/"_qs;
+
+Q_GLOBAL_STATIC(QGfxShaderCache, g_shaderCache)
+
+[[nodiscard]] static inline qsizetype qgfx_memoryCost(const qint64 maximumSize)
+{
+    // A maximum size of zero means unlimited, same as for the disk.
+    return ((maximumSize > 0) ? qsizetype(maximumSize) : std::numeric_limits<qsizetype>::max());
+}
+
+// A read-only view of one baked shader, so that QFile (and thus QQuickShaderEffect)
+// can load it without anything being written to the disk.
+class QGfxShaderFileEngine : public QAbstractFileEngine
+{
+    Q_DISABLE_COPY_MOVE(QGfxShaderFileEngine)
+
+public:
+    explicit QGfxShaderFileEngine(const QString &fileName, const QByteArray &data)
+        : m_fileName(fileName), m_data(data) {}
+    ~QGfxShaderFileEngine() override = default;
+
+#if (QT_VERSION >= QT_VERSION_CHECK(6, 3, 0))
+    [[nodiscard]] bool open(QIODevice::OpenMode openMode, std::optional<QFile::Permissions> permissions) override
+    {
+        Q_UNUSED(permissions);
+#else
+    [[nodiscard]] bool open(QIODevice::OpenMode openMode) override
+    {
+#endif
+        if (openMode & (QIODevice::WriteOnly | QIODevice::Append | QIODevice::Truncate)) {
+            setError(QFile::OpenError, u"Baked shaders are read-only."_qs);
+            return false;
+        }
+        m_pos = 0;
+        return true;
+    }
+
+    [[nodiscard]] bool close() override
+    {
+        return true;
+    }
+
+    [[nodiscard]] qint64 size() const override
+    {
+        return m_data.size();
+    }
+
+    [[nodiscard]] qint64 pos() const override
+    {
+        return m_pos;
+    }
+
+    [[nodiscard]] bool seek(qint64 pos) override
+    {
+        if ((pos < 0) || (pos > m_data.size())) {
+            return false;
+        }
+        m_pos = pos;
+        return true;
+    }
+
+    [[nodiscard]] qint64 read(char *data, qint64 maxlen) override
+    {
+        const qint64 length = qMin(maxlen, (m_data.size() - m_pos));
+        if (length <= 0) {
+            return 0;
+        }
+        memcpy(data, (m_data.constData() + m_pos), size_t(length));
+        m_pos += length;
+        return length;
+    }
+
+    [[nodiscard]] FileFlags fileFlags(FileFlags type) const override
+    {
+        return ((ReadOwnerPerm | ReadUserPerm | ReadGroupPerm | ReadOtherPerm | FileType | ExistsFlag) & type);
+    }
+
+    [[nodiscard]] QString fileName(FileName file) const override
+    {
+        Q_UNUSED(file);
+        return m_fileName;
+    }
+
+private:
+    QString m_fileName = {};
+    QByteArray m_data = {};
+    qint64 m_pos = 0;
+};
+
+class QGfxShaderFileEngineHandler : public QAbstractFileEngineHandler
+{
+    Q_DISABLE_COPY_MOVE(QGfxShaderFileEngineHandler)
+
+public:
+    explicit QGfxShaderFileEngineHandler(QGfxShaderCache *cache) : m_cache(cache) {}
+    ~QGfxShaderFileEngineHandler() override = default;
+
+#if (QT_VERSION >= QT_VERSION_CHECK(6, 8, 0))
+    [[nodiscard]] std::unique_ptr<QAbstractFileEngine> create(const QString &fileName) const override
+#else
+    [[nodiscard]] QAbstractFileEngine *create(const QString &fileName) const override
+#endif
+    {
+        // Every single file access of the process goes through here, bail out early.
+        if (!fileName.startsWith(kBakedShaderPath) || !fileName.endsWith(kFileSuffix)) {
+            return nullptr;
+        }
+        const QByteArray key = QStringView(fileName).sliced(kBakedShaderPath.size())
+                                   .chopped(kFileSuffix.size()).toLatin1();
+        const QByteArray data = m_cache->bakedShader(key);
+        if (data.isEmpty()) {
+            return nullptr;
+        }
+#if (QT_VERSION >= QT_VERSION_CHECK(6, 8, 0))
+        return std::make_unique<QGfxShaderFileEngine>(fileName, data);
+#else
+        return new QGfxShaderFileEngine(fileName, data);
+#endif
+    }
+
+private:
+    QGfxShaderCache *m_cache = nullptr;
+};
+
+QGfxShaderCache::QGfxShaderCache() : m_fileEngineHandler(new QGfxShaderFileEngineHandler(this))
+{
+    m_maximumSize = sc_defaultMaximumSize;
+    if (qEnvironmentVariableIsSet(kMaximumSizeEnvVar)) {
+        bool ok = false;
+        const qint64 size = qEnvironmentVariable(kMaximumSizeEnvVar).toLongLong(&ok);
+        if (ok && (size >= 0)) {
+            m_maximumSize = size;
+        }
+    }
+    m_bakedShaders.setMaxCost(qgfx_memoryCost(m_maximumSize));
+    if (qEnvironmentVariableIntValue(kDisableEnvVar) != 0) {
+        return;
+    }
+    const QString cacheRoot = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (cacheRoot.isEmpty()) {
+        qWarning() << "QGfxShaderCache: Failed to resolve the cache location, the shader cache will be disabled.";
+        return;
+    }
+    m_directory = cacheRoot + u"/qtacrylicmaterial/shaders"_qs;
+    if (!QDir().mkpath(m_directory)) {
+        qWarning() << "QGfxShaderCache: Failed to create the cache directory" << m_directory;
+        return;
+    }
+    m_enabled = true;
+}
+
+QGfxShaderCache::~QGfxShaderCache() = default;
+
+QGfxShaderCache *QGfxShaderCache::instance()
+{
+    return g_shaderCache();
+}
+
+QByteArray QGfxShaderCache::cacheKey(const QByteArray &code, const QShader::Stage stage,
+                                     const QList<QShaderBaker::GeneratedShader> &targets,
+                                     const QList<QShader::Variant> &variants,
+                                     const QSGRendererInterface::GraphicsApi graphicsApi)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(code);
+    // The serialization format and the shader compilers may change between
+    // Qt releases, so never share blobs between different Qt versions.
+    hash.addData(QByteArray(qVersion()));
+    QByteArray meta = {};
+    meta += QByteArray::number(int(stage)) + ';';
+    meta += QByteArray::number(int(graphicsApi)) + ';';
+    for (auto &&target : std::as_const(targets)) {
+        meta += QByteArray::number(int(target.first)) + ':';
+        meta += QByteArray::number(target.second.version()) + ':';
+        meta += QByteArray::number(int(target.second.flags())) + ';';
+    }
+    for (auto &&variant : std::as_const(variants)) {
+        meta += QByteArray::number(int(variant)) + ';';
+    }
+    hash.addData(meta);
+    return hash.result().toHex();
+}
+
+std::optional<QGfxShaderUrls> QGfxShaderCache::find(const QGfxShaderKey &key)
+{
+    QMutexLocker locker(&m_memoryMutex);
+    const auto it = m_shaders.constFind(key);
+    if (it == m_shaders.constEnd()) {
+        return std::nullopt;
+    }
+    // Also marks the baked shaders as recently used.
+    if (!isBakedShaderAvailable(it.value().vertexShader) || !isBakedShaderAvailable(it.value().fragmentShader)) {
+        m_shaders.erase(it);
+        return std::nullopt;
+    }
+    ++m_memoryHitCount;
+    return it.value();
+}
+
+void QGfxShaderCache::insert(const QGfxShaderKey &key, const QGfxShaderUrls &urls)
+{
+    QMutexLocker locker(&m_memoryMutex);
+    m_shaders.insert(key, urls);
+}
+
+QUrl QGfxShaderCache::findBaked(const QByteArray &key) const
+{
+    QMutexLocker locker(&m_memoryMutex);
+    if (!m_bakedShaders.object(key)) {
+        return {};
+    }
+    return QUrl(u"qrc"_qs + kBakedShaderPath + QString::fromLatin1(key) + kFileSuffix);
+}
+
+QUrl QGfxShaderCache::insertBaked(const QByteArray &key, const QByteArray &serializedShader,
+                                  const QGfxShaderRecipe &recipe)
+{
+    Q_ASSERT(!key.isEmpty());
+    Q_ASSERT(!serializedShader.isEmpty());
+    Q_ASSERT(!recipe.code.isEmpty());
+    if (key.isEmpty() || serializedShader.isEmpty()) {
+        return {};
+    }
+    QMutexLocker locker(&m_memoryMutex);
+    if (!recipe.code.isEmpty()) {
+        m_bakeRecipes.insert(key, recipe);
+    }
+    const qsizetype expectedCount = (m_bakedShaders.size() + (m_bakedShaders.contains(key) ? 0 : 1));
+    if (!m_bakedShaders.insert(key, new QByteArray(serializedShader), serializedShader.size())) {
+        qWarning() << "QGfxShaderCache: The baked shader is larger than the whole cache.";
+        return {};
+    }
+    if (m_bakedShaders.size() < expectedCount) {
+        dropStaleShaders();
+    }
+    return QUrl(u"qrc"_qs + kBakedShaderPath + QString::fromLatin1(key) + kFileSuffix);
+}
+
+QByteArray QGfxShaderCache::bakedShader(const QByteArray &key)
+{
+    {
+        QMutexLocker locker(&m_memoryMutex);
+        if (const QByteArray * const data = m_bakedShaders.object(key)) {
+            return *data;
+        }
+    }
+    return rebake(key);
+}
+
+QShader QGfxShaderCache::load(const QByteArray &key)
+{
+    if (!m_enabled || key.isEmpty()) {
+        return {};
+    }
+    QMutexLocker locker(&m_mutex);
+    QFile file(filePath(key));
+    if (!file.open(QFile::ReadOnly)) {
+        ++m_missCount;
+        return {};
+    }
+    const QShader shader = QShader::fromSerialized(file.readAll());
+    file.close();
+    if (!shader.isValid()) {
+        // Corrupted or written by an incompatible version, don't let it stay around.
+        qWarning() << "QGfxShaderCache: Discarding invalid cache entry" << file.fileName();
+        if (m_size >= 0) {
+            m_size = qMax(qint64(0), (m_size - file.size()));
+        }
+        file.remove();
+        ++m_missCount;
+        return {};
+    }
+    // Refresh the modification time so that the eviction is LRU rather than FIFO.
+    if (file.open(QFile::ReadWrite)) {
+        file.setFileTime(QDateTime::currentDateTimeUtc(), QFileDevice::FileModificationTime);
+        file.close();
+    }
+    ++m_hitCount;
+    return shader;
+}
+
+void QGfxShaderCache::store(const QByteArray &key, const QShader &shader)
+{
+    if (!m_enabled || key.isEmpty() || !shader.isValid()) {
+        return;
+    }
+    const QByteArray data = shader.serialized();
+    QMutexLocker locker(&m_mutex);
+    if ((m_maximumSize > 0) && (data.size() > m_maximumSize)) {
+        return;
+    }
+    ensureSizeKnown();
+    const QString path = filePath(key);
+    const qint64 oldSize = QFileInfo(path).size();
+    // Other processes may be looking at the same file, so replace it atomically.
+    QSaveFile file(path);
+    if (!file.open(QFile::WriteOnly)) {
+        qWarning() << "QGfxShaderCache: Failed to write cache entry" << path;
+        return;
+    }
+    file.write(data);
+    if (!file.commit()) {
+        qWarning() << "QGfxShaderCache: Failed to commit cache entry" << path;
+        return;
+    }
+    m_size += (data.size() - oldSize);
+    trim();
+}
+
+void QGfxShaderCache::clear()
+{
+    if (!m_enabled) {
+        return;
+    }
+    QMutexLocker locker(&m_mutex);
+    QDir dir(m_directory);
+    const QStringList files = dir.entryList(kNameFilters, QDir::Files);
+    for (auto &&file : std::as_const(files)) {
+        dir.remove(file);
+    }
+    m_size = 0;
+}
+
+QString QGfxShaderCache::directory() const
+{
+    return m_directory;
+}
+
+bool QGfxShaderCache::isEnabled() const
+{
+    return m_enabled;
+}
+
+qint64 QGfxShaderCache::maximumSize() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_maximumSize;
+}
+
+void QGfxShaderCache::setMaximumSize(const qint64 value)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_maximumSize == value) {
+        return;
+    }
+    m_maximumSize = qMax(qint64(0), value);
+    {
+        QMutexLocker memoryLocker(&m_memoryMutex);
+        m_bakedShaders.setMaxCost(qgfx_memoryCost(m_maximumSize));
+        dropStaleShaders();
+    }
+    if (m_enabled) {
+        ensureSizeKnown();
+        trim();
+    }
+}
+
+qint64 QGfxShaderCache::size() const
+{
+    QMutexLocker locker(&m_mutex);
+    return qMax(qint64(0), m_size);
+}
+
+quint64 QGfxShaderCache::hitCount() const
+{
+    return m_hitCount;
+}
+
+quint64 QGfxShaderCache::missCount() const
+{
+    return m_missCount;
+}
+
+quint64 QGfxShaderCache::memoryHitCount() const
+{
+    return m_memoryHitCount;
+}
+
+void QGfxShaderCache::recordAvoidedRebuild()
+{
+    ++m_avoidedRebuildCount;
+}
+
+quint64 QGfxShaderCache::avoidedRebuildCount() const
+{
+    return m_avoidedRebuildCount;
+}
+
+QString QGfxShaderCache::filePath(const QByteArray &key) const
+{
+    return m_directory + u'/' + QString::fromLatin1(key) + kFileSuffix;
+}
+
+QByteArray QGfxShaderCache::bakedShaderKey(const QUrl &url)
+{
+    const QString prefix = (u"qrc"_qs + kBakedShaderPath);
+    const QString path = url.toString();
+    if (!path.startsWith(prefix) || !path.endsWith(kFileSuffix)) {
+        return {};
+    }
+    return QStringView(path).sliced(prefix.size()).chopped(kFileSuffix.size()).toLatin1();
+}
+
+bool QGfxShaderCache::isBakedShaderAvailable(const QUrl &url) const
+{
+    // Anything which isn't baked by us, prebaked shaders for example, never goes away.
+    const QByteArray key = bakedShaderKey(url);
+    return (key.isEmpty() || m_bakedShaders.object(key));
+}
+
+QByteArray QGfxShaderCache::rebake(const QByteArray &key)
+{
+    QGfxShaderRecipe recipe = {};
+    {
+        QMutexLocker locker(&m_memoryMutex);
+        const auto it = m_bakeRecipes.constFind(key);
+        if (it == m_bakeRecipes.constEnd()) {
+            return {};
+        }
+        recipe = it.value();
+    }
+    // Don't hold any lock while baking, the builder may be baking on other threads.
+    QShader shader = load(key);
+    if (!shader.isValid()) {
+        QShaderBaker baker{};
+        baker.setGeneratedShaders(recipe.targets);
+        baker.setGeneratedShaderVariants(recipe.variants);
+        baker.setSourceString(recipe.code, recipe.stage);
+        shader = baker.bake();
+        if (!shader.isValid()) {
+            qWarning() << "QGfxShaderCache: Failed to bake an evicted shader again:" << baker.errorMessage();
+            return {};
+        }
+        store(key, shader);
+    }
+    const QByteArray data = shader.serialized();
+    if (insertBaked(key, data, recipe).isEmpty()) {
+        return {};
+    }
+    return data;
+}
+
+void QGfxShaderCache::dropStaleShaders()
+{
+    for (auto it = m_shaders.begin(); it != m_shaders.end();) {
+        const QByteArray vertexKey = bakedShaderKey(it.value().vertexShader);
+        const QByteArray fragmentKey = bakedShaderKey(it.value().fragmentShader);
+        if ((!vertexKey.isEmpty() && !m_bakedShaders.contains(vertexKey))
+            || (!fragmentKey.isEmpty() && !m_bakedShaders.contains(fragmentKey))) {
+            it = m_shaders.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void QGfxShaderCache::ensureSizeKnown()
+{
+    if (m_size >= 0) {
+        return;
+    }
+    m_size = 0;
+    const QFileInfoList files = QDir(m_directory).entryInfoList(kNameFilters, QDir::Files);
+    for (auto &&file : std::as_const(files)) {
+        m_size += file.size();
+    }
+}
+
+void QGfxShaderCache::trim()
+{
+    // A maximum size of zero means unlimited.
+    if ((m_maximumSize <= 0) || (m_size <= m_maximumSize)) {
+        return;
+    }
+    // Evict the least recently used entries first. Go a bit below the limit
+    // to avoid trimming again on every single store.
+    const qint64 target = ((m_maximumSize / 4) * 3);
+    QDir dir(m_directory);
+    const QFileInfoList files = dir.entryInfoList(kNameFilters, QDir::Files, (QDir::Time | QDir::Reversed));
+    for (auto &&file : std::as_const(files)) {
+        if (m_size <= target) {
+            break;
+        }
+        if (dir.remove(file.fileName())) {
+            m_size -= file.size();
+        }
+    }
+    m_size = qMax(qint64(0), m_size);
+}
+
+QT_END_NAMESPACE
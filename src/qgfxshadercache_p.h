@@ -0,0 +1,169 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2022 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "qtacrylicmaterial_global.h"
+#include <QtCore/qcache.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qscopedpointer.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qurl.h>
+#include <QtShaderTools/private/qshaderbaker_p.h>
+#include <QtQuick/qsgrendererinterface.h>
+#include <atomic>
+#include <optional>
+
+QT_BEGIN_NAMESPACE
+
+class QAbstractFileEngineHandler;
+
+struct QGfxShaderKey
+{
+    qreal radius = 0.0;
+    qreal deviation = 0.0;
+    bool masked = false;
+    bool alphaOnly = false;
+    bool fallback = false;
+    bool dynamicKernel = false; // The kernel is fed through uniforms, radius and deviation don't matter.
+    bool opaque = false; // The source (the background of a blend) has no transparent texels.
+    bool opaqueForeground = false; // Only meaningful for blend shaders.
+    bool solidForeground = false; // Blend shaders taking the foreground as a color uniform.
+    int blendMode = -1; // Negative values mean it's not a blend shader.
+    QByteArray blendLayers = {}; // The sequence of layers of a blend stack shader, empty for everything else.
+    int maxSamples = 0; // The backend limit the kernel was chosen for, resolved by the builder if zero.
+    QSGRendererInterface::GraphicsApi backend = QSGRendererInterface::Unknown;
+
+    [[nodiscard]] friend bool operator==(const QGfxShaderKey &lhs, const QGfxShaderKey &rhs) = default;
+};
+
+[[nodiscard]] inline size_t qHash(const QGfxShaderKey &key, const size_t seed = 0) noexcept
+{
+    return qHashMulti(seed, key.radius, key.deviation, int(key.masked), int(key.alphaOnly),
+                      int(key.fallback), int(key.dynamicKernel), int(key.opaque), int(key.opaqueForeground),
+                      int(key.solidForeground), key.blendMode, key.blendLayers, key.maxSamples, int(key.backend));
+}
+
+struct QGfxShaderUrls
+{
+    QUrl vertexShader = {};
+    QUrl fragmentShader = {};
+
+    [[nodiscard]] bool isValid() const
+    {
+        return (!vertexShader.isEmpty() || !fragmentShader.isEmpty());
+    }
+};
+
+// Everything needed to bake a shader again after its blob got evicted.
+struct QGfxShaderRecipe
+{
+    QByteArray code = {};
+    QShader::Stage stage = QShader::VertexStage;
+    QList<QShaderBaker::GeneratedShader> targets = {};
+    QList<QShader::Variant> variants = {};
+    QSGRendererInterface::GraphicsApi graphicsApi = QSGRendererInterface::Unknown;
+};
+
+class QTACRYLICMATERIAL_API QGfxShaderCache
+{
+    Q_DISABLE_COPY_MOVE(QGfxShaderCache)
+
+public:
+    explicit QGfxShaderCache();
+    ~QGfxShaderCache();
+
+    [[nodiscard]] static QGfxShaderCache *instance();
+
+    [[nodiscard]] static QByteArray cacheKey(const QByteArray &code, const QShader::Stage stage,
+                                             const QList<QShaderBaker::GeneratedShader> &targets,
+                                             const QList<QShader::Variant> &variants,
+                                             const QSGRendererInterface::GraphicsApi graphicsApi);
+
+    // In-memory, process-wide cache of ready-to-use shaders.
+    [[nodiscard]] std::optional<QGfxShaderUrls> find(const QGfxShaderKey &key);
+    void insert(const QGfxShaderKey &key, const QGfxShaderUrls &urls);
+    // Baked shaders never touch the file system, they are served from memory
+    // through a virtual resource path which QQuickShaderEffect can read directly.
+    // They are limited to maximumSize() as well, the least recently used ones are
+    // dropped first, along with the entries of find() which refer to them. Effects
+    // may still hold the URL of a dropped shader and load it again at any time, so
+    // the recipe of every baked shader is kept and the blob gets baked again (or
+    // loaded from the disk) when such a URL is read.
+    [[nodiscard]] QUrl findBaked(const QByteArray &key) const;
+    [[nodiscard]] QUrl insertBaked(const QByteArray &key, const QByteArray &serializedShader,
+                                   const QGfxShaderRecipe &recipe);
+    [[nodiscard]] QByteArray bakedShader(const QByteArray &key);
+
+    // Persistent, on-disk cache of serialized shaders.
+    [[nodiscard]] QShader load(const QByteArray &key);
+    void store(const QByteArray &key, const QShader &shader);
+    void clear();
+
+    [[nodiscard]] QString directory() const;
+    [[nodiscard]] bool isEnabled() const;
+
+    [[nodiscard]] qint64 maximumSize() const;
+    void setMaximumSize(const qint64 value);
+
+    [[nodiscard]] qint64 size() const;
+    [[nodiscard]] quint64 hitCount() const;
+    [[nodiscard]] quint64 missCount() const;
+    [[nodiscard]] quint64 memoryHitCount() const;
+
+    // Rebuild requests of the effects which got merged into an already pending one.
+    void recordAvoidedRebuild();
+    [[nodiscard]] quint64 avoidedRebuildCount() const;
+
+private:
+    [[nodiscard]] QString filePath(const QByteArray &key) const;
+    void ensureSizeKnown();
+    void trim();
+    [[nodiscard]] static QByteArray bakedShaderKey(const QUrl &url);
+    [[nodiscard]] QByteArray rebake(const QByteArray &key);
+    // Both need m_memoryMutex to be locked.
+    [[nodiscard]] bool isBakedShaderAvailable(const QUrl &url) const;
+    void dropStaleShaders();
+
+private:
+    mutable QMutex m_mutex;
+    mutable QMutex m_memoryMutex;
+    QHash<QGfxShaderKey, QGfxShaderUrls> m_shaders = {};
+    // The cost of a baked shader is its size in bytes.
+    mutable QCache<QByteArray, QByteArray> m_bakedShaders;
+    // Only the sources, they are tiny compared to the baked blobs.
+    QHash<QByteArray, QGfxShaderRecipe> m_bakeRecipes = {};
+    QScopedPointer<QAbstractFileEngineHandler> m_fileEngineHandler;
+    QString m_directory = {};
+    bool m_enabled = false;
+    qint64 m_maximumSize = 0;
+    qint64 m_size = -1;
+    std::atomic<quint64> m_hitCount = 0;
+    std::atomic<quint64> m_missCount = 0;
+    std::atomic<quint64> m_memoryHitCount = 0;
+    std::atomic<quint64> m_avoidedRebuildCount = 0;
+};
+
+QT_END_NAMESPACE
@@ -39,12 +39,26 @@
 ****************************************************************************/
 
 #include "qgfxsourceproxy_p.h"
+#include <QtCore/qmath.h>
+#include <QtCore/qmetaobject.h>
+#include <QtQuick/qquickwindow.h>
 #include <QtQuick/private/qquickshadereffectsource_p.h>
 #include <QtQuick/private/qquickitem_p.h>
 #include <QtQuick/private/qquickimage_p.h>
 
 QT_BEGIN_NAMESPACE
 
+[[nodiscard]] static inline QMetaObject::Connection qgfx_connectToMethod(const QObject *sender, const QMetaMethod &signal, const QObject *receiver, const char *method)
+{
+    const QMetaObject * const receiverMetaObject = receiver->metaObject();
+    const int methodIndex = receiverMetaObject->indexOfMethod(QMetaObject::normalizedSignature(method).constData());
+    Q_ASSERT(methodIndex >= 0);
+    if (methodIndex < 0) {
+        return {};
+    }
+    return QObject::connect(sender, signal, receiver, receiverMetaObject->method(methodIndex));
+}
+
 QGfxSourceProxy::QGfxSourceProxy(QQuickItem *parent) : QQuickItem(parent)
 {
     qRegisterMetaType<Interpolation>();
@@ -68,6 +82,8 @@ void QGfxSourceProxy::setInput(QQuickItem *input)
             connect(image, &QQuickImage::fillModeChanged, this, &QGfxSourceProxy::repolish);
         }
         connect(m_input, &QQuickItem::childrenChanged, this, &QGfxSourceProxy::repolish);
+        connect(m_input, &QQuickItem::widthChanged, this, &QGfxSourceProxy::repolish);
+        connect(m_input, &QQuickItem::heightChanged, this, &QGfxSourceProxy::repolish);
     }
     Q_EMIT inputChanged();
 }
@@ -92,6 +108,24 @@ void QGfxSourceProxy::setSourceRect(const QRectF &sourceRect)
     Q_EMIT sourceRectChanged();
 }
 
+void QGfxSourceProxy::setTextureScale(const qreal scale)
+{
+    if (qFuzzyCompare(m_textureScale, scale)) {
+        return;
+    }
+    m_textureScale = scale;
+    polish();
+}
+
+void QGfxSourceProxy::setFormat(const QQuickShaderEffectSource::Format format)
+{
+    if (m_format == format) {
+        return;
+    }
+    m_format = format;
+    polish();
+}
+
 void QGfxSourceProxy::setInterpolation(const Interpolation i)
 {
     if (m_interpolation == i) {
@@ -111,6 +145,15 @@ void QGfxSourceProxy::useProxy()
     m_proxy->setSourceRect(m_sourceRect);
     m_proxy->setSourceItem(m_input);
     m_proxy->setSmooth(m_interpolation != Interpolation::Nearest);
+    m_proxy->setFormat(m_format);
+    // An empty size makes the proxy follow the input's size.
+    QSize textureSize = {};
+    if ((m_textureScale < 1.0) && window()) {
+        const qreal scale = (window()->effectiveDevicePixelRatio() * m_textureScale);
+        const QSizeF size = (m_sourceRect.isEmpty() ? m_input->size() : m_sourceRect.size());
+        textureSize = QSize(qMax(1, qCeil(size.width() * scale)), qMax(1, qCeil(size.height() * scale)));
+    }
+    m_proxy->setTextureSize(textureSize);
     setOutput(m_proxy.get());
 }
 
@@ -137,6 +180,45 @@ QQuickItemLayer *QGfxSourceProxy::findLayer(QQuickItem *item)
     return nullptr;
 }
 
+bool QGfxSourceProxy::isOpaque(const QQuickItem *item)
+{
+    return (item && item->property("opaque").toBool());
+}
+
+QMetaObject::Connection QGfxSourceProxy::connectOpaqueChanged(const QQuickItem *item, const QObject *receiver, const char *method)
+{
+    Q_ASSERT(receiver);
+    Q_ASSERT(method);
+    if (!item || !receiver || !method) {
+        return {};
+    }
+    const QMetaObject * const itemMetaObject = item->metaObject();
+    const int propertyIndex = itemMetaObject->indexOfProperty("opaque");
+    if (propertyIndex < 0) {
+        return {};
+    }
+    const QMetaProperty property = itemMetaObject->property(propertyIndex);
+    if (!property.hasNotifySignal()) {
+        return {};
+    }
+    return qgfx_connectToMethod(item, property.notifySignal(), receiver, method);
+}
+
+QMetaObject::Connection QGfxSourceProxy::connectContentChanged(const QQuickItem *item, const QObject *receiver, const char *method)
+{
+    Q_ASSERT(receiver);
+    Q_ASSERT(method);
+    if (!item || !receiver || !method) {
+        return {};
+    }
+    const QMetaObject * const itemMetaObject = item->metaObject();
+    const int signalIndex = itemMetaObject->indexOfSignal("contentChanged()");
+    if (signalIndex < 0) {
+        return {};
+    }
+    return qgfx_connectToMethod(item, itemMetaObject->method(signalIndex), receiver, method);
+}
+
 void QGfxSourceProxy::updatePolish()
 {
     if (m_input == nullptr) {
@@ -43,11 +43,10 @@
 #include "qtacrylicmaterial_global.h"
 #include <QtQml/qqmlregistration.h>
 #include <QtQuick/qquickitem.h>
+#include <QtQuick/private/qquickshadereffectsource_p.h>
 
 QT_BEGIN_NAMESPACE
 
-class QQuickShaderEffectSource;
-
 class QTACRYLICMATERIAL_API QGfxSourceProxy : public QQuickItem
 {
     Q_OBJECT
@@ -81,6 +80,25 @@ public:
     void setInterpolation(const Interpolation i);
     [[nodiscard]] Interpolation interpolation() const { return m_interpolation; }
 
+    // Only affect the texture of the internal proxy, items which are used
+    // directly are never touched.
+    void setTextureScale(const qreal scale);
+    [[nodiscard]] qreal textureScale() const { return m_textureScale; }
+
+    void setFormat(const QQuickShaderEffectSource::Format format);
+    [[nodiscard]] QQuickShaderEffectSource::Format format() const { return m_format; }
+
+    // Items promise that they never have any transparent pixels through a boolean
+    // "opaque" property, plain QML items can simply declare one. The effects use
+    // cheaper shaders for such inputs.
+    [[nodiscard]] static bool isOpaque(const QQuickItem *item);
+    // Invokes the receiver's method whenever the item's "opaque" property changes.
+    // Returns an invalid connection for items without such a property.
+    static QMetaObject::Connection connectOpaqueChanged(const QQuickItem *item, const QObject *receiver, const char *method);
+    // Cached effects only re-render when told so, their sources can announce new
+    // content through a contentChanged() signal.
+    static QMetaObject::Connection connectContentChanged(const QQuickItem *item, const QObject *receiver, const char *method);
+
 protected:
     void updatePolish() override;
 
@@ -105,6 +123,8 @@ private:
     QQuickItem *m_output = nullptr;
     QScopedPointer<QQuickShaderEffectSource> m_proxy;
     Interpolation m_interpolation = Interpolation::Any;
+    qreal m_textureScale = 1.0;
+    QQuickShaderEffectSource::Format m_format = QQuickShaderEffectSource::RGBA8;
 };
 
 QT_END_NAMESPACE
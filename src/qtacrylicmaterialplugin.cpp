@@ -28,6 +28,7 @@
 #include "quickdesktopwallpaper.h"
 #include "quickgaussianblur.h"
 #include "quickblend.h"
+#include "quickblendstack.h"
 #include "quickacrylicmaterial.h"
 #include <QtQml/qqmlengine.h>
 
@@ -39,6 +40,8 @@ void QtAcrylicMaterial::registerTypes(QQmlEngine *engine)
     qmlRegisterType<QuickDesktopWallpaper>(QTACRYLICMATERIAL_QUICK_URI, 1, 0, "DesktopWallpaper");
     qmlRegisterType<QuickGaussianBlur>(QTACRYLICMATERIAL_QUICK_URI, 1, 0, "GaussianBlur");
     qmlRegisterType<QuickBlend>(QTACRYLICMATERIAL_QUICK_URI, 1, 0, "Blend");
+    qmlRegisterType<QuickBlendLayer>(QTACRYLICMATERIAL_QUICK_URI, 1, 0, "BlendLayer");
+    qmlRegisterType<QuickBlendStack>(QTACRYLICMATERIAL_QUICK_URI, 1, 0, "BlendStack");
     qmlRegisterType<QuickAcrylicMaterial>(QTACRYLICMATERIAL_QUICK_URI, 1, 0, "AcrylicMaterial");
     qmlRegisterModule(QTACRYLICMATERIAL_QUICK_URI, 1, 0);
 }
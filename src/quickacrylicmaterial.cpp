@@ -25,20 +25,24 @@
 #include "quickacrylicmaterial.h"
 #include "quickacrylicmaterial_p.h"
 #include "quickgaussianblur.h"
-#include "quickblend.h"
+#include "qgfxsourceproxy_p.h"
+#include "qgfxshaderbuilder_p.h"
+#include <QtGui/qvector2d.h>
 #include <QtGui/qpa/qplatformtheme.h>
 #include <QtGui/private/qguiapplication_p.h>
 #include <QtQuick/private/qquickanchors_p.h>
 #include <QtQuick/private/qquickimage_p.h>
-#include <QtQuick/private/qquickrectangle_p.h>
+#include <QtQuick/private/qquickitem_p.h>
+#include <QtQuick/private/qquickshadereffect_p.h>
 
 static constexpr const QColor sc_defaultTintColor = { 255, 255, 255, 204 };
 static constexpr const qreal sc_defaultTintOpacity = 1.0;
 static constexpr const qreal sc_defaultNoiseOpacity = 0.02;
 static constexpr const QColor sc_defaultFallbackColor = QColorConstants::Black;
 [[maybe_unused]] static constexpr const qreal sc_defaultBlurRadius = 30.0;
-[[maybe_unused]] static constexpr const QColor sc_defaultExclusionColor = { 255, 255, 255, 26 };
-[[maybe_unused]] static constexpr const qreal sc_defaultSaturation = 1.25;
+static constexpr const QColor sc_defaultExclusionColor = { 255, 255, 255, 26 };
+static constexpr const qreal sc_defaultSaturation = 1.25;
+static constexpr const QSizeF sc_noiseTextureSize = { 256.0, 256.0 }; // assets/noise_256x256.png
 
 namespace Preset
 {
@@ -101,15 +105,28 @@ void QuickAcrylicMaterialPrivate::updateAcrylicAppearance()
 {
     Q_Q(QuickAcrylicMaterial);
 
-    m_luminosityColorEffect->setColor(calculateEffectiveLuminosityColor(m_tintColor, m_tintOpacity, m_luminosityOpacity));
-    m_tintColorEffect->setColor(calculateEffectiveTintColor(m_tintColor, m_tintOpacity, m_luminosityOpacity));
-    m_noiseBorderEffect->setOpacity(m_noiseOpacity);
-    m_fallbackColorEffect->setColor(m_fallbackColor);
+    m_parameters.luminosityColor = calculateEffectiveLuminosityColor(m_tintColor, m_tintOpacity, m_luminosityOpacity);
+    m_parameters.tintColor = calculateEffectiveTintColor(m_tintColor, m_tintOpacity, m_luminosityOpacity);
+    m_parameters.noiseOpacity = m_noiseOpacity;
+    m_parameters.fallbackColor = m_fallbackColor;
+    m_parameters.exclusionColor = m_exclusionColor;
+    m_parameters.saturation = m_saturation;
+
+    // The fallback color is shown until the blur is available.
+    const bool ready = m_blurredSource->isReady();
+    const bool active = (ready && (q->window() ? q->window()->isActive() : false));
+    m_parameters.fallback = (active ? 0.0 : 1.0);
+
+    applyCompositeParameters();
+    updateBlurUsage();
+    if (m_nativeRendering) {
+        q->update();
+    }
 
-    const bool active = (q->window() ? q->window()->isActive() : false);
-    m_tintBlendEffect->setVisible(active);
-    m_noiseBorderEffect->setVisible(active);
-    m_fallbackColorEffect->setVisible(!active);
+    if (m_ready != ready) {
+        m_ready = ready;
+        Q_EMIT q->readyChanged();
+    }
 }
 
 void QuickAcrylicMaterialPrivate::rebindWindow()
@@ -128,6 +145,79 @@ void QuickAcrylicMaterialPrivate::rebindWindow()
                        this, &QuickAcrylicMaterialPrivate::updateAcrylicAppearance);
 }
 
+void QuickAcrylicMaterialPrivate::updateNoiseScale()
+{
+    Q_Q(QuickAcrylicMaterial);
+    // The native node loads the same image, without an item to ask for its size.
+    m_parameters.noiseScale = QVector2D(q->width() / sc_noiseTextureSize.width(), q->height() / sc_noiseTextureSize.height());
+    if (m_compositeEffect) {
+        m_compositeEffect->setProperty("noiseScale", m_parameters.noiseScale);
+    }
+    if (m_nativeRendering) {
+        q->update();
+    }
+}
+
+void QuickAcrylicMaterialPrivate::applyCompositeParameters()
+{
+    if (!m_compositeEffect) {
+        return;
+    }
+    m_compositeEffect->setProperty("luminosityColor", m_parameters.luminosityColor);
+    m_compositeEffect->setProperty("tintColor", m_parameters.tintColor);
+    m_compositeEffect->setProperty("noiseScale", m_parameters.noiseScale);
+    m_compositeEffect->setProperty("noiseOpacity", m_parameters.noiseOpacity);
+    m_compositeEffect->setProperty("fallbackColor", m_parameters.fallbackColor);
+    m_compositeEffect->setProperty("fallback", m_parameters.fallback);
+    m_compositeEffect->setProperty("exclusionColor", m_parameters.exclusionColor);
+    m_compositeEffect->setProperty("saturation", m_parameters.saturation);
+}
+
+void QuickAcrylicMaterialPrivate::updateRenderingMode()
+{
+    Q_Q(QuickAcrylicMaterial);
+    q->setFlag(QQuickItem::ItemHasContents, m_nativeRendering);
+    q->setClip(!m_nativeRendering);
+    // The node replaces all of them, so they only exist without it.
+    if (m_nativeRendering) {
+        m_compositeEffect.reset();
+        m_noiseTexture.reset();
+        m_blurredSourceProxy.reset();
+    } else if (!m_compositeEffect) {
+        createNoiseTexture();
+        createCompositeEffect();
+        applyCompositeParameters();
+    }
+    updateBlurUsage();
+    q->update();
+}
+
+void QuickAcrylicMaterialPrivate::updateBlurUsage()
+{
+    // Nothing of the blur shows through the fallback color, so it's not rendered
+    // at all while the fallback color is shown.
+    const bool blurVisible = (m_parameters.fallback < 1.0);
+    // Without an input the proxy drops its offscreen copy of the blur.
+    if (m_blurredSourceProxy) {
+        m_blurredSourceProxy->setInput(blurVisible ? m_blurredSource.get() : nullptr);
+    }
+    // The node renders the blur into its own layer. Like the source of a
+    // ShaderEffectSource with hideSource, it's kept out of the window itself.
+    const bool nodeUsesBlur = (m_nativeRendering && blurVisible);
+    if (m_nodeUsesBlur == nodeUsesBlur) {
+        return;
+    }
+    m_nodeUsesBlur = nodeUsesBlur;
+    QQuickItemPrivate * const blurredSourcePrivate = QQuickItemPrivate::get(m_blurredSource.get());
+    if (m_nodeUsesBlur) {
+        blurredSourcePrivate->refFromEffectItem(true);
+        m_blurredSource->setVisible(true);
+    } else {
+        m_blurredSource->setVisible(false);
+        blurredSourcePrivate->derefFromEffectItem(true);
+    }
+}
+
 bool QuickAcrylicMaterialPrivate::eventFilter(QObject *object, QEvent *event)
 {
     Q_ASSERT(object);
@@ -168,81 +258,41 @@ void QuickAcrylicMaterialPrivate::createBlurredSource()
     // Ideally, the blur samples should be twice as large as the highest required radius value plus one.
     static constexpr const int maximumBlurSamples = qRound(maximumBlurRadius * 2.0);
     m_blurredSource->setSamples(maximumBlurSamples);
+    // Such a big kernel is a lot cheaper on a downsampled copy of the source, which
+    // is also shared with all the other materials blurring the same source.
+    m_blurredSource->setPyramid(true);
     m_blurredSource->setVisible(false);
     const auto blurredSourceAnchors = new QQuickAnchors(m_blurredSource.get(), m_blurredSource.get());
     blurredSourceAnchors->setFill(q);
 }
 
-void QuickAcrylicMaterialPrivate::createLuminosityColorEffect()
-{
-    Q_Q(QuickAcrylicMaterial);
-    m_luminosityColorEffect.reset(new QQuickRectangle(q));
-    QQuickPen * const border = m_luminosityColorEffect->border();
-    border->setWidth(0.0);
-    border->setColor(QColorConstants::Transparent);
-    m_luminosityColorEffect->setVisible(false);
-    const auto luminosityColorEffectAnchors = new QQuickAnchors(m_luminosityColorEffect.get(), m_luminosityColorEffect.get());
-    luminosityColorEffectAnchors->setFill(q);
-}
-
-void QuickAcrylicMaterialPrivate::createLuminosityBlendEffect()
-{
-    Q_Q(QuickAcrylicMaterial);
-    m_luminosityBlendEffect.reset(new QuickBlend(q));
-    m_luminosityBlendEffect->setMode(QuickBlend::Mode::Lightness);
-    m_luminosityBlendEffect->setBackground(m_blurredSource.get());
-    m_luminosityBlendEffect->setForeground(m_luminosityColorEffect.get());
-    m_luminosityBlendEffect->setVisible(false);
-    const auto luminosityBlendEffectAnchors = new QQuickAnchors(m_luminosityBlendEffect.get(), m_luminosityBlendEffect.get());
-    luminosityBlendEffectAnchors->setFill(q);
-}
-
-void QuickAcrylicMaterialPrivate::createTintColorEffect()
-{
-    Q_Q(QuickAcrylicMaterial);
-    m_tintColorEffect.reset(new QQuickRectangle(q));
-    QQuickPen * const border = m_tintColorEffect->border();
-    border->setWidth(0.0);
-    border->setColor(QColorConstants::Transparent);
-    m_tintColorEffect->setVisible(false);
-    const auto tintColorEffectAnchors = new QQuickAnchors(m_tintColorEffect.get(), m_tintColorEffect.get());
-    tintColorEffectAnchors->setFill(q);
-}
-
-void QuickAcrylicMaterialPrivate::createTintBlendEffect()
-{
-    Q_Q(QuickAcrylicMaterial);
-    m_tintBlendEffect.reset(new QuickBlend(q));
-    m_tintBlendEffect->setMode(QuickBlend::Mode::Color);
-    m_tintBlendEffect->setBackground(m_luminosityBlendEffect.get());
-    m_tintBlendEffect->setForeground(m_tintColorEffect.get());
-    m_tintBlendEffect->setVisible(false);
-    const auto tintBlendEffectAnchors = new QQuickAnchors(m_tintBlendEffect.get(), m_tintBlendEffect.get());
-    tintBlendEffectAnchors->setFill(q);
-}
-
-void QuickAcrylicMaterialPrivate::createNoiseBorderEffect()
+void QuickAcrylicMaterialPrivate::createNoiseTexture()
 {
     Q_Q(QuickAcrylicMaterial);
-    m_noiseBorderEffect.reset(new QQuickImage(q));
+    m_noiseTexture.reset(new QQuickImage(q));
     initResource();
-    m_noiseBorderEffect->setSource(QUrl(u"qrc:///org/wangwenx190/QtAcrylicMaterial/assets/noise_256x256.png"_qs));
-    m_noiseBorderEffect->setFillMode(QQuickImage::Tile);
-    m_noiseBorderEffect->setVisible(false);
-    const auto noiseBorderEffectAnchors = new QQuickAnchors(m_noiseBorderEffect.get(), m_noiseBorderEffect.get());
-    noiseBorderEffectAnchors->setFill(q);
+    m_noiseTexture->setSource(QUrl(u"qrc:///org/wangwenx190/QtAcrylicMaterial/assets/noise_256x256.png"_qs));
+    // Tiled by the composite shader, which needs the texels as they are.
+    m_noiseTexture->setSmooth(false);
+    m_noiseTexture->setVisible(false);
 }
 
-void QuickAcrylicMaterialPrivate::createFallbackColorEffect()
+void QuickAcrylicMaterialPrivate::createCompositeEffect()
 {
     Q_Q(QuickAcrylicMaterial);
-    m_fallbackColorEffect.reset(new QQuickRectangle(q));
-    QQuickPen * const border = m_fallbackColorEffect->border();
-    border->setWidth(0.0);
-    border->setColor(QColorConstants::Transparent);
-    m_fallbackColorEffect->setVisible(false);
-    const auto fallbackColorEffectAnchors = new QQuickAnchors(m_fallbackColorEffect.get(), m_fallbackColorEffect.get());
-    fallbackColorEffectAnchors->setFill(q);
+    // The input is set by updateBlurUsage().
+    m_blurredSourceProxy.reset(new QGfxSourceProxy(q));
+    m_compositeEffect.reset(new QQuickShaderEffect(q));
+    const QGfxShaderUrls shaders = QGfxShaderBuilder::staticShaders(u"composite"_qs);
+    m_compositeEffect->setVertexShader(shaders.vertexShader);
+    m_compositeEffect->setFragmentShader(shaders.fragmentShader);
+    m_compositeEffect->setProperty("source", QVariant::fromValue(m_blurredSourceProxy->output()));
+    m_compositeEffect->setProperty("noiseSource", QVariant::fromValue(static_cast<QQuickItem *>(m_noiseTexture.get())));
+    connect(m_blurredSourceProxy.get(), &QGfxSourceProxy::outputChanged, this, [this](){
+        m_compositeEffect->setProperty("source", QVariant::fromValue(m_blurredSourceProxy->output()));
+    });
+    const auto compositeEffectAnchors = new QQuickAnchors(m_compositeEffect.get(), m_compositeEffect.get());
+    compositeEffectAnchors->setFill(q);
 }
 
 void QuickAcrylicMaterialPrivate::initialize()
@@ -255,21 +305,25 @@ void QuickAcrylicMaterialPrivate::initialize()
     connect(q, &QuickAcrylicMaterial::luminosityOpacityChanged, this, &QuickAcrylicMaterialPrivate::updateAcrylicAppearance);
     connect(q, &QuickAcrylicMaterial::noiseOpacityChanged, this, &QuickAcrylicMaterialPrivate::updateAcrylicAppearance);
     connect(q, &QuickAcrylicMaterial::fallbackColorChanged, this, &QuickAcrylicMaterialPrivate::updateAcrylicAppearance);
+    connect(q, &QuickAcrylicMaterial::saturationChanged, this, &QuickAcrylicMaterialPrivate::updateAcrylicAppearance);
+    connect(q, &QuickAcrylicMaterial::exclusionColorChanged, this, &QuickAcrylicMaterialPrivate::updateAcrylicAppearance);
 
     m_tintColor = sc_defaultTintColor;
     m_tintOpacity = sc_defaultTintOpacity;
     m_noiseOpacity = sc_defaultNoiseOpacity;
     m_fallbackColor = sc_defaultFallbackColor;
+    m_saturation = sc_defaultSaturation;
+    m_exclusionColor = sc_defaultExclusionColor;
 
     createBlurredSource();
-    createLuminosityColorEffect();
-    createLuminosityBlendEffect();
-    createTintColorEffect();
-    createTintBlendEffect();
-    createNoiseBorderEffect();
-    createFallbackColorEffect();
+    updateRenderingMode();
+
+    connect(m_blurredSource.get(), &QuickGaussianBlur::readyChanged, this, &QuickAcrylicMaterialPrivate::updateAcrylicAppearance);
+    connect(q, &QuickAcrylicMaterial::widthChanged, this, &QuickAcrylicMaterialPrivate::updateNoiseScale);
+    connect(q, &QuickAcrylicMaterial::heightChanged, this, &QuickAcrylicMaterialPrivate::updateNoiseScale);
 
     updateAcrylicAppearance();
+    updateNoiseScale();
 
     subscribeSystemThemeChangeNotification();
 }
@@ -423,6 +477,10 @@ void QuickAcrylicMaterial::setSource(QQuickItem *item)
     }
     d->m_source = item;
     d->m_blurredSource->setSource(d->m_source);
+    // The blur only needs to run again when something changed, as long as the
+    // source tells us about its new content, which DesktopWallpaper does. The
+    // composite pass on top of it is cheap enough to run in every frame.
+    d->m_blurredSource->setCached(d->m_source->metaObject()->indexOfSignal("contentChanged()") >= 0);
     Q_EMIT sourceChanged();
 }
 
@@ -592,6 +650,130 @@ void QuickAcrylicMaterial::setFallbackColor(const QColor &color)
     Q_EMIT fallbackColorChanged();
 }
 
+qreal QuickAcrylicMaterial::saturation() const
+{
+    Q_D(const QuickAcrylicMaterial);
+    return d->m_saturation;
+}
+
+void QuickAcrylicMaterial::setSaturation(const qreal value)
+{
+    Q_D(QuickAcrylicMaterial);
+    const qreal saturation = qMax(0.0, value);
+    if (qFuzzyCompare(d->m_saturation, saturation)) {
+        return;
+    }
+    d->m_saturation = saturation;
+    Q_EMIT saturationChanged();
+}
+
+QColor QuickAcrylicMaterial::exclusionColor() const
+{
+    Q_D(const QuickAcrylicMaterial);
+    return d->m_exclusionColor;
+}
+
+void QuickAcrylicMaterial::setExclusionColor(const QColor &color)
+{
+    Q_ASSERT(color.isValid());
+    if (!color.isValid()) {
+        return;
+    }
+    Q_D(QuickAcrylicMaterial);
+    if (d->m_exclusionColor == color) {
+        return;
+    }
+    d->m_exclusionColor = color;
+    Q_EMIT exclusionColorChanged();
+}
+
+bool QuickAcrylicMaterial::isReady() const
+{
+    Q_D(const QuickAcrylicMaterial);
+    return d->m_ready;
+}
+
+QuickGaussianBlur::Algorithm QuickAcrylicMaterial::blurAlgorithm() const
+{
+    Q_D(const QuickAcrylicMaterial);
+    return d->m_blurredSource->algorithm();
+}
+
+void QuickAcrylicMaterial::setBlurAlgorithm(const QuickGaussianBlur::Algorithm value)
+{
+    Q_D(QuickAcrylicMaterial);
+    if (d->m_blurredSource->algorithm() == value) {
+        return;
+    }
+    d->m_blurredSource->setAlgorithm(value);
+    Q_EMIT blurAlgorithmChanged();
+}
+
+bool QuickAcrylicMaterial::isIncrementalBlur() const
+{
+    Q_D(const QuickAcrylicMaterial);
+    return d->m_blurredSource->isIncremental();
+}
+
+void QuickAcrylicMaterial::setIncrementalBlur(const bool value)
+{
+    Q_D(QuickAcrylicMaterial);
+    if (d->m_blurredSource->isIncremental() == value) {
+        return;
+    }
+    d->m_blurredSource->setIncremental(value);
+    Q_EMIT incrementalBlurChanged();
+}
+
+int QuickAcrylicMaterial::blurUpdateInterval() const
+{
+    Q_D(const QuickAcrylicMaterial);
+    return d->m_blurredSource->updateInterval();
+}
+
+void QuickAcrylicMaterial::setBlurUpdateInterval(const int value)
+{
+    Q_D(QuickAcrylicMaterial);
+    if (d->m_blurredSource->updateInterval() == value) {
+        return;
+    }
+    d->m_blurredSource->setUpdateInterval(value);
+    Q_EMIT blurUpdateIntervalChanged();
+}
+
+bool QuickAcrylicMaterial::isBlurTemporalBlending() const
+{
+    Q_D(const QuickAcrylicMaterial);
+    return d->m_blurredSource->isTemporalBlending();
+}
+
+void QuickAcrylicMaterial::setBlurTemporalBlending(const bool value)
+{
+    Q_D(QuickAcrylicMaterial);
+    if (d->m_blurredSource->isTemporalBlending() == value) {
+        return;
+    }
+    d->m_blurredSource->setTemporalBlending(value);
+    Q_EMIT blurTemporalBlendingChanged();
+}
+
+bool QuickAcrylicMaterial::isNativeRendering() const
+{
+    Q_D(const QuickAcrylicMaterial);
+    return d->m_nativeRendering;
+}
+
+void QuickAcrylicMaterial::setNativeRendering(const bool value)
+{
+    Q_D(QuickAcrylicMaterial);
+    if (d->m_nativeRendering == value) {
+        return;
+    }
+    d->m_nativeRendering = value;
+    d->updateRenderingMode();
+    Q_EMIT nativeRenderingChanged();
+}
+
 void QuickAcrylicMaterial::itemChange(const ItemChange change, const ItemChangeData &value)
 {
     QQuickItem::itemChange(change, value);
@@ -602,3 +784,19 @@ void QuickAcrylicMaterial::itemChange(const ItemChange change, const ItemChangeD
         value.window->installEventFilter(d);
     }
 }
+
+QSGNode *QuickAcrylicMaterial::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data)
+{
+    Q_UNUSED(data);
+    Q_D(QuickAcrylicMaterial);
+    if (!d->m_nativeRendering || (width() <= 0.0) || (height() <= 0.0)) {
+        delete oldNode;
+        return nullptr;
+    }
+    auto node = static_cast<QGfxAcrylicNode *>(oldNode);
+    if (!node) {
+        node = new QGfxAcrylicNode(this);
+    }
+    node->sync(d->m_blurredSource.get(), size(), window()->effectiveDevicePixelRatio(), d->m_parameters);
+    return node;
+}
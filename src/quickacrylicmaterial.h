@@ -25,6 +25,7 @@
 #pragma once
 
 #include "qtacrylicmaterial_global.h"
+#include "quickgaussianblur.h"
 #include <QtQml/qqmlregistration.h>
 #include <QtQuick/qquickitem.h>
 
@@ -44,6 +45,14 @@ class QTACRYLICMATERIAL_API QuickAcrylicMaterial : public QQuickItem
     Q_PROPERTY(qreal luminosityOpacity READ luminosityOpacity WRITE setLuminosityOpacity NOTIFY luminosityOpacityChanged FINAL)
     Q_PROPERTY(qreal noiseOpacity READ noiseOpacity WRITE setNoiseOpacity NOTIFY noiseOpacityChanged FINAL)
     Q_PROPERTY(QColor fallbackColor READ fallbackColor WRITE setFallbackColor NOTIFY fallbackColorChanged FINAL)
+    Q_PROPERTY(qreal saturation READ saturation WRITE setSaturation NOTIFY saturationChanged FINAL)
+    Q_PROPERTY(QColor exclusionColor READ exclusionColor WRITE setExclusionColor NOTIFY exclusionColorChanged FINAL)
+    Q_PROPERTY(bool ready READ isReady NOTIFY readyChanged FINAL)
+    Q_PROPERTY(QuickGaussianBlur::Algorithm blurAlgorithm READ blurAlgorithm WRITE setBlurAlgorithm NOTIFY blurAlgorithmChanged FINAL)
+    Q_PROPERTY(bool incrementalBlur READ isIncrementalBlur WRITE setIncrementalBlur NOTIFY incrementalBlurChanged FINAL)
+    Q_PROPERTY(int blurUpdateInterval READ blurUpdateInterval WRITE setBlurUpdateInterval NOTIFY blurUpdateIntervalChanged FINAL)
+    Q_PROPERTY(bool blurTemporalBlending READ isBlurTemporalBlending WRITE setBlurTemporalBlending NOTIFY blurTemporalBlendingChanged FINAL)
+    Q_PROPERTY(bool nativeRendering READ isNativeRendering WRITE setNativeRendering NOTIFY nativeRenderingChanged FINAL)
 
 public:
     enum class Theme
@@ -76,8 +85,41 @@ public:
     [[nodiscard]] QColor fallbackColor() const;
     void setFallbackColor(const QColor &color);
 
+    // Applied to the blurred source before anything else, 1.0 leaves it as is.
+    [[nodiscard]] qreal saturation() const;
+    void setSaturation(const qreal value);
+
+    // Exclusion blended onto the saturated source, a transparent color disables it.
+    [[nodiscard]] QColor exclusionColor() const;
+    void setExclusionColor(const QColor &color);
+
+    [[nodiscard]] bool isReady() const;
+
+    [[nodiscard]] QuickGaussianBlur::Algorithm blurAlgorithm() const;
+    void setBlurAlgorithm(const QuickGaussianBlur::Algorithm value);
+
+    // See GaussianBlur::incremental, worth it for live sources.
+    [[nodiscard]] bool isIncrementalBlur() const;
+    void setIncrementalBlur(const bool value);
+
+    // See GaussianBlur::updateInterval and GaussianBlur::temporalBlending.
+    [[nodiscard]] int blurUpdateInterval() const;
+    void setBlurUpdateInterval(const int value);
+
+    [[nodiscard]] bool isBlurTemporalBlending() const;
+    void setBlurTemporalBlending(const bool value);
+
+    // Draws the material with a scene graph node of its own instead of a shader
+    // effect item on top of the blur. The composite effect, its noise image and
+    // the offscreen copy of the blur are not created then, and the material
+    // doesn't need to clip. The blur and its passes are still items, and as every
+    // node renders the blur into a layer of its own, materials are never batched.
+    [[nodiscard]] bool isNativeRendering() const;
+    void setNativeRendering(const bool value);
+
 protected:
     void itemChange(const ItemChange change, const ItemChangeData &value) override;
+    [[nodiscard]] QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
 
 Q_SIGNALS:
     void sourceChanged();
@@ -87,6 +129,14 @@ Q_SIGNALS:
     void luminosityOpacityChanged();
     void noiseOpacityChanged();
     void fallbackColorChanged();
+    void saturationChanged();
+    void exclusionColorChanged();
+    void readyChanged();
+    void blurAlgorithmChanged();
+    void incrementalBlurChanged();
+    void blurUpdateIntervalChanged();
+    void blurTemporalBlendingChanged();
+    void nativeRenderingChanged();
 
 private:
     QScopedPointer<QuickAcrylicMaterialPrivate> d_ptr;
@@ -26,16 +26,17 @@
 
 #include "qtacrylicmaterial_global.h"
 #include "quickacrylicmaterial.h"
+#include "qgfxacrylicnode_p.h"
 #include <QtCore/qobject.h>
 #include <QtGui/qcolor.h>
 
 QT_BEGIN_NAMESPACE
 class QQuickImage;
-class QQuickRectangle;
+class QQuickShaderEffect;
 QT_END_NAMESPACE
 
+class QGfxSourceProxy;
 class QuickGaussianBlur;
-class QuickBlend;
 
 class QTACRYLICMATERIAL_API QuickAcrylicMaterialPrivate : public QObject
 {
@@ -63,18 +64,18 @@ public:
 public Q_SLOTS:
     void updateAcrylicAppearance();
     void rebindWindow();
+    void updateNoiseScale();
 
 protected:
     [[nodiscard]] bool eventFilter(QObject *object, QEvent *event) override;
 
 private:
     void createBlurredSource();
-    void createLuminosityColorEffect();
-    void createLuminosityBlendEffect();
-    void createTintColorEffect();
-    void createTintBlendEffect();
-    void createNoiseBorderEffect();
-    void createFallbackColorEffect();
+    void createNoiseTexture();
+    void createCompositeEffect();
+    void applyCompositeParameters();
+    void updateRenderingMode();
+    void updateBlurUsage();
     void initialize();
 
 private:
@@ -86,15 +87,18 @@ private:
     std::optional<qreal> m_luminosityOpacity = std::nullopt;
     qreal m_noiseOpacity = 0.0;
     QColor m_fallbackColor = {};
+    qreal m_saturation = 1.0;
+    QColor m_exclusionColor = {};
     QScopedPointer<QuickGaussianBlur> m_blurredSource;
-    QScopedPointer<QQuickRectangle> m_luminosityColorEffect;
-    QScopedPointer<QuickBlend> m_luminosityBlendEffect;
-    QScopedPointer<QQuickRectangle> m_tintColorEffect;
-    QScopedPointer<QuickBlend> m_tintBlendEffect;
-    QScopedPointer<QQuickImage> m_noiseBorderEffect;
-    QScopedPointer<QQuickRectangle> m_fallbackColorEffect;
+    QScopedPointer<QGfxSourceProxy> m_blurredSourceProxy;
+    QScopedPointer<QQuickImage> m_noiseTexture;
+    QScopedPointer<QQuickShaderEffect> m_compositeEffect;
+    QGfxAcrylicParameters m_parameters = {};
+    bool m_nativeRendering = false;
+    bool m_nodeUsesBlur = false;
     QMetaObject::Connection m_windowActiveChangeConnection = {};
     bool m_useSystemTheme = false;
     bool m_settingSystemTheme = false;
     bool m_forceChangeProperty = false;
+    bool m_ready = false;
 };
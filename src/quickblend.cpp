@@ -26,135 +26,12 @@
 #include "quickblend_p.h"
 #include "qgfxsourceproxy_p.h"
 #include "qgfxshaderbuilder_p.h"
+#include <QtCore/qmetaobject.h>
+#include <QtCore/qfuturewatcher.h>
 #include <QtQuick/private/qquickshadereffect_p.h>
 #include <QtQuick/private/qquickshadereffectsource_p.h>
 #include <QtQuick/private/qquickanchors_p.h>
-
-static const QByteArray fragmentShaderBegin = R"(#version 440
-
-layout(location = 0) in vec2 qt_TexCoord0;
-layout(location = 0) out vec4 fragColor;
-
-layout(std140, binding = 0) uniform buf {
-    mat4 qt_Matrix;
-    float qt_Opacity;
-};
-layout(binding = 1) uniform sampler2D source;
-layout(binding = 2) uniform sampler2D foregroundSource;
-
-float RGBtoL(vec3 color) {
-    float cmin = min(color.r, min(color.g, color.b));
-    float cmax = max(color.r, max(color.g, color.b));
-    float l = (cmin + cmax) / 2.0;
-    return l;
-}
-
-vec3 RGBtoHSL(vec3 color) {
-    float cmin = min(color.r, min(color.g, color.b));
-    float cmax = max(color.r, max(color.g, color.b));
-    float h = 0.0;
-    float s = 0.0;
-    float l = (cmin + cmax) / 2.0;
-    float diff = cmax - cmin;
-
-    if (diff > 1.0 / 256.0) {
-        if (l < 0.5)
-            s = diff / (cmin + cmax);
-        else
-            s = diff / (2.0 - (cmin + cmax));
-
-        if (color.r == cmax)
-            h = (color.g - color.b) / diff;
-        else if (color.g == cmax)
-            h = 2.0 + (color.b - color.r) / diff;
-        else
-            h = 4.0 + (color.r - color.g) / diff;
-
-        h /= 6.0;
-    }
-    return vec3(h, s, l);
-}
-
-float hueToIntensity(float v1, float v2, float h) {
-    h = fract(h);
-    if (h < 1.0 / 6.0)
-        return v1 + (v2 - v1) * 6.0 * h;
-    else if (h < 1.0 / 2.0)
-        return v2;
-    else if (h < 2.0 / 3.0)
-        return v1 + (v2 - v1) * 6.0 * (2.0 / 3.0 - h);
-
-    return v1;
-}
-
-vec3 HSLtoRGB(vec3 color) {
-    float h = color.x;
-    float l = color.z;
-    float s = color.y;
-
-    if (s < 1.0 / 256.0)
-        return vec3(l, l, l);
-
-    float v1;
-    float v2;
-    if (l < 0.5)
-        v2 = l * (1.0 + s);
-    else
-        v2 = (l + s) - (s * l);
-
-    v1 = 2.0 * l - v2;
-
-    float d = 1.0 / 3.0;
-    float r = hueToIntensity(v1, v2, h + d);
-    float g = hueToIntensity(v1, v2, h);
-    float b = hueToIntensity(v1, v2, h - d);
-    return vec3(r, g, b);
-}
-
-float channelBlendHardLight(float c1, float c2) {
-    return c2 > 0.5 ? (1.0 - (1.0 - 2.0 * (c2 - 0.5)) * (1.0 - c1)) : (2.0 * c1 * c2);
-}
-
-void main() {
-    vec4 result = vec4(0.0);
-    vec4 color1 = texture(source, qt_TexCoord0);
-    vec4 color2 = texture(foregroundSource, qt_TexCoord0);
-    vec3 rgb1 = color1.rgb / max(1.0/256.0, color1.a);
-    vec3 rgb2 = color2.rgb / max(1.0/256.0, color2.a);
-    float a = max(color1.a, color1.a * color2.a);
-)"_qba;
-
-static const QByteArray fragmentShaderEnd = R"(
-    fragColor.rgb = mix(rgb1, result.rgb, color2.a);
-    fragColor.rbg *= a;
-    fragColor.a = a;
-    fragColor *= qt_Opacity;
-}
-)"_qba;
-
-static const QByteArray blendModeAddition = "result.rgb = min(rgb1 + rgb2, 1.0);\n"_qba;
-static const QByteArray blendModeAverage = "result.rgb = 0.5 * (rgb1 + rgb2);\n"_qba;
-static const QByteArray blendModeColor = "result.rgb = HSLtoRGB(vec3(RGBtoHSL(rgb2).xy, RGBtoL(rgb1)));\n"_qba;
-static const QByteArray blendModeColorBurn = "result.rgb = clamp(1.0 - ((1.0 - rgb1) / max(vec3(1.0 / 256.0), rgb2)), vec3(0.0), vec3(1.0));\n"_qba;
-static const QByteArray blendModeColorDodge = "result.rgb = clamp(rgb1 / max(vec3(1.0 / 256.0), (1.0 - rgb2)), vec3(0.0), vec3(1.0));\n"_qba;
-static const QByteArray blendModeDarken = "result.rgb = min(rgb1, rgb2);\n"_qba;
-static const QByteArray blendModeDarkerColor = "result.rgb = 0.3 * rgb1.r + 0.59 * rgb1.g + 0.11 * rgb1.b > 0.3 * rgb2.r + 0.59 * rgb2.g + 0.11 * rgb2.b ? rgb2 : rgb1;\n"_qba;
-static const QByteArray blendModeDifference = "result.rgb = abs(rgb1 - rgb2);\n"_qba;
-static const QByteArray blendModeDivide = "result.rgb = clamp(rgb1 / rgb2, 0.0, 1.0);\n"_qba;
-static const QByteArray blendModeExclusion = "result.rgb = rgb1 + rgb2 - 2.0 * rgb1 * rgb2;\n"_qba;
-static const QByteArray blendModeHardLight = "result.rgb = vec3(channelBlendHardLight(rgb1.r, rgb2.r), channelBlendHardLight(rgb1.g, rgb2.g), channelBlendHardLight(rgb1.b, rgb2.b));\n"_qba;
-static const QByteArray blendModeHue = "result.rgb = HSLtoRGB(vec3(RGBtoHSL(rgb2).x, RGBtoHSL(rgb1).yz));\n"_qba;
-static const QByteArray blendModeLighten = "result.rgb = max(rgb1, rgb2);\n"_qba;
-static const QByteArray blendModeLighterColor = "result.rgb = 0.3 * rgb1.r + 0.59 * rgb1.g + 0.11 * rgb1.b > 0.3 * rgb2.r + 0.59 * rgb2.g + 0.11 * rgb2.b ? rgb1 : rgb2;\n"_qba;
-static const QByteArray blendModeLightness = "result.rgb = HSLtoRGB(vec3(RGBtoHSL(rgb1).xy, RGBtoL(rgb2)));\n"_qba;
-static const QByteArray blendModeMultiply = "result.rgb = rgb1 * rgb2;\n"_qba;
-static const QByteArray blendModeNegation = "result.rgb = 1.0 - abs(1.0 - rgb1 - rgb2);\n"_qba;
-static const QByteArray blendModeNormal = "result.rgb = rgb2; a = max(color1.a, color2.a);\n"_qba;
-static const QByteArray blendModeSaturation = "vec3 hsl1 = RGBtoHSL(rgb1); result.rgb = HSLtoRGB(vec3(hsl1.x, RGBtoHSL(rgb2).y, hsl1.z));\n"_qba;
-static const QByteArray blendModeScreen = "result.rgb = 1.0 - (vec3(1.0) - rgb1) * (vec3(1.0) - rgb2);\n"_qba;
-static const QByteArray blendModeSubtract = "result.rgb = max(rgb1 - rgb2, vec3(0.0));\n"_qba;
-static const QByteArray blendModeSoftLight = "result.rgb = rgb1 * ((1.0 - rgb1) * rgb2 + (1.0 - (1.0 - rgb1) * (1.0 - rgb2)));\n"_qba;
-static const QByteArray blendModeDefault = "gl_FragColor = vec4(1.0, 0.0, 0.0, 1.0);\n"_qba;
+#include <QtQuick/private/qquickrectangle_p.h>
 
 QuickBlendPrivate::QuickBlendPrivate(QuickBlend *q) : QObject(q)
 {
@@ -186,25 +63,187 @@ const QuickBlendPrivate *QuickBlendPrivate::get(const QuickBlend *pub)
     return pub->d_func();
 }
 
+void QuickBlendPrivate::scheduleRebuild()
+{
+    // Collect all the changes and rebuild once, right before the next frame.
+    if (m_rebuildScheduled) {
+        QGfxShaderCache::instance()->recordAvoidedRebuild();
+        return;
+    }
+    m_rebuildScheduled = true;
+    Q_Q(QuickBlend);
+    q->polish();
+}
+
 void QuickBlendPrivate::buildFragmentShader()
 {
+    m_rebuildScheduled = false;
     m_shaderItem->setProperty("source", QVariant::fromValue(m_backgroundSourceProxy->output()));
-    m_shaderItem->setProperty("foregroundSource", QVariant::fromValue(m_foregroundSourceProxy->output()));
-    const QByteArray shader = generateShaderCode(m_mode);
-    const QUrl fragmentShaderUrl = m_shaderBuilder->buildFragmentShader(shader);
-    m_shaderItem->setFragmentShader(fragmentShaderUrl);
+    if (!m_solidForeground) {
+        m_shaderItem->setProperty("foregroundSource", QVariant::fromValue(m_foregroundSourceProxy->output()));
+    }
+    const bool opaqueBackground = QGfxSourceProxy::isOpaque(m_background);
+    // Un-premultiplying a solid color costs nothing, it doesn't need a variant.
+    const bool opaqueForeground = (!m_solidForeground && QGfxSourceProxy::isOpaque(m_foreground));
+    const bool solidForeground = m_solidForeground;
+    // All the blend modes are baked at build time, for normal and for opaque
+    // backgrounds, with textured and with solid foregrounds. Generating them at
+    // runtime is only needed when the prebaked shaders have been disabled, or
+    // for opaque foregrounds, which are rare.
+    const quint64 generation = ++m_shaderGeneration;
+    if (!opaqueForeground) {
+        const QByteArray modeName = QByteArray(QMetaEnum::fromType<Mode>().valueToKey(int(m_mode))).toLower();
+        const QString suffix = ((opaqueBackground ? u"_opaque"_qs : QString()) + (solidForeground ? u"_solid"_qs : QString()));
+        const QUrl prebakedShaderUrl = QGfxShaderBuilder::prebakedShader(u"blend_%1%2.frag.qsb"_qs.arg(QString::fromLatin1(modeName), suffix));
+        if (!prebakedShaderUrl.isEmpty()) {
+            m_shaderItem->setFragmentShader(prebakedShaderUrl);
+            setReady(true);
+            invalidate();
+            return;
+        }
+    }
+    QGfxShaderKey key = {};
+    key.blendMode = int(m_mode);
+    key.opaque = opaqueBackground;
+    key.opaqueForeground = opaqueForeground;
+    key.solidForeground = solidForeground;
+    key.backend = QGfxShaderBuilder::graphicsApi();
+    const QFuture<QUrl> future = QGfxShaderBuilder::fragmentShaderAsync(key, [mode = m_mode, opaqueBackground, opaqueForeground, solidForeground](){
+        return generateShaderCode(mode, opaqueBackground, opaqueForeground, solidForeground);
+    });
+    if (future.isFinished()) {
+        const QUrl fragmentShaderUrl = future.result();
+        m_shaderItem->setFragmentShader(fragmentShaderUrl);
+        setReady(!fragmentShaderUrl.isEmpty());
+        invalidate();
+        return;
+    }
+    // The previous blend mode stays on screen until the new one has been baked.
+    setReady(false);
+    const auto watcher = new QFutureWatcher<QUrl>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, generation](){
+        watcher->deleteLater();
+        if (generation != m_shaderGeneration) {
+            return;
+        }
+        const QUrl fragmentShaderUrl = watcher->result();
+        m_shaderItem->setFragmentShader(fragmentShaderUrl);
+        setReady(!fragmentShaderUrl.isEmpty());
+        invalidate();
+    });
+    watcher->setFuture(future);
+}
+
+void QuickBlendPrivate::invalidate()
+{
+    // See QuickGaussianBlurPrivate::invalidate().
+    if (m_cached) {
+        m_cacheItem->scheduleUpdate();
+    }
+    Q_Q(QuickBlend);
+    Q_EMIT q->contentChanged();
+}
+
+void QuickBlendPrivate::updateSolidForeground()
+{
+    const std::optional<QColor> color = solidForegroundColor();
+    const bool solid = color.has_value();
+    if (solid) {
+        m_shaderItem->setProperty("foregroundColor", color.value());
+        m_shaderItem->setProperty("foregroundHSL", rgbToHsl(color.value()));
+    }
+    // There's no need to keep an offscreen copy of a solid foreground.
+    m_foregroundSourceProxy->setInput(solid ? nullptr : m_foreground);
+    if (m_solidForeground != solid) {
+        m_solidForeground = solid;
+        scheduleRebuild();
+    }
+    invalidate();
+}
+
+void QuickBlendPrivate::trackForegroundRectangle()
+{
+    for (auto &&connection : std::as_const(m_foregroundRectangleConnections)) {
+        disconnect(connection);
+    }
+    m_foregroundRectangleConnections.clear();
+    const auto rectangle = qobject_cast<QQuickRectangle *>(m_foreground);
+    if (!rectangle) {
+        return;
+    }
+    m_foregroundRectangleConnections = {
+        connect(rectangle, &QQuickRectangle::colorChanged, this, &QuickBlendPrivate::updateSolidForeground),
+        connect(rectangle, &QQuickRectangle::radiusChanged, this, &QuickBlendPrivate::updateSolidForeground),
+        connect(rectangle, &QQuickRectangle::opacityChanged, this, &QuickBlendPrivate::updateSolidForeground),
+        connect(rectangle, &QQuickRectangle::childrenChanged, this, &QuickBlendPrivate::updateSolidForeground),
+        connect(rectangle->border(), &QQuickPen::widthChanged, this, &QuickBlendPrivate::updateSolidForeground),
+        connect(rectangle->border(), &QQuickPen::colorChanged, this, &QuickBlendPrivate::updateSolidForeground)
+    };
+}
+
+std::optional<QColor> QuickBlendPrivate::solidForegroundColor() const
+{
+    if (m_foregroundColor.isValid()) {
+        return m_foregroundColor;
+    }
+    // The whole rectangle is a single color as long as nothing else is drawn on it.
+    const auto rectangle = qobject_cast<QQuickRectangle *>(m_foreground);
+    if (!rectangle || rectangle->border()->isValid() || (rectangle->radius() > 0.0)
+        || !rectangle->gradient().isUndefined() || !rectangle->childItems().isEmpty()
+        || !qFuzzyCompare(rectangle->opacity(), 1.0)) {
+        return std::nullopt;
+    }
+    return rectangle->color();
+}
+
+QVector3D QuickBlendPrivate::rgbToHsl(const QColor &color)
+{
+    // Must give the same results as RGBtoHSL() in blend.frag.
+    const float r = color.redF();
+    const float g = color.greenF();
+    const float b = color.blueF();
+    const float cmin = qMin(r, qMin(g, b));
+    const float cmax = qMax(r, qMax(g, b));
+    const float l = ((cmin + cmax) / 2.0f);
+    const float diff = (cmax - cmin);
+    float h = 0.0f;
+    float s = 0.0f;
+    if (diff > (1.0f / 256.0f)) {
+        s = ((l < 0.5f) ? (diff / (cmin + cmax)) : (diff / (2.0f - (cmin + cmax))));
+        if (r == cmax) {
+            h = ((g - b) / diff);
+        } else if (g == cmax) {
+            h = (2.0f + ((b - r) / diff));
+        } else {
+            h = (4.0f + ((r - g) / diff));
+        }
+        h /= 6.0f;
+    }
+    return QVector3D(h, s, l);
+}
+
+void QuickBlendPrivate::setReady(const bool value)
+{
+    if (m_ready == value) {
+        return;
+    }
+    m_ready = value;
+    Q_Q(QuickBlend);
+    Q_EMIT q->readyChanged();
 }
 
 void QuickBlendPrivate::initialize()
 {
     Q_Q(QuickBlend);
-    connect(q, &QuickBlend::modeChanged, this, &QuickBlendPrivate::buildFragmentShader);
+    connect(q, &QuickBlend::modeChanged, this, &QuickBlendPrivate::scheduleRebuild);
+    connect(q, &QuickBlend::opaqueChanged, this, &QuickBlendPrivate::scheduleRebuild);
+    connect(q, &QuickBlend::widthChanged, this, &QuickBlendPrivate::invalidate);
+    connect(q, &QuickBlend::heightChanged, this, &QuickBlendPrivate::invalidate);
 
     m_backgroundSourceProxy.reset(new QGfxSourceProxy(q));
-    connect(m_backgroundSourceProxy.get(), &QGfxSourceProxy::outputChanged, this, &QuickBlendPrivate::buildFragmentShader);
+    connect(m_backgroundSourceProxy.get(), &QGfxSourceProxy::outputChanged, this, &QuickBlendPrivate::scheduleRebuild);
     m_foregroundSourceProxy.reset(new QGfxSourceProxy(q));
-    connect(m_foregroundSourceProxy.get(), &QGfxSourceProxy::outputChanged, this, &QuickBlendPrivate::buildFragmentShader);
-    m_shaderBuilder.reset(new QGfxShaderBuilder(q));
+    connect(m_foregroundSourceProxy.get(), &QGfxSourceProxy::outputChanged, this, &QuickBlendPrivate::scheduleRebuild);
     m_shaderItem.reset(new QQuickShaderEffect(q));
     const auto shaderItemAnchors = new QQuickAnchors(m_shaderItem.get(), m_shaderItem.get());
     shaderItemAnchors->setFill(q);
@@ -213,86 +252,21 @@ void QuickBlendPrivate::initialize()
     cacheItemAnchors->setFill(q);
     m_cacheItem->setSmooth(true);
     m_cacheItem->setSourceItem(m_shaderItem.get());
-    m_cacheItem->setLive(true);
+    m_cacheItem->setLive(false);
     m_cacheItem->setHideSource(m_cached);
     m_cacheItem->setVisible(m_cached);
 
-    buildFragmentShader();
+    scheduleRebuild();
 }
 
-QByteArray QuickBlendPrivate::generateShaderCode(const Mode mode) const
+QByteArray QuickBlendPrivate::generateShaderCode(const Mode mode, const bool opaqueBackground, const bool opaqueForeground, const bool solidForeground)
 {
-    QByteArray shader = fragmentShaderBegin;
-    switch (mode) {
-    case Mode::Addition:
-        shader += blendModeAddition;
-        break;
-    case Mode::Average:
-        shader += blendModeAverage;
-        break;
-    case Mode::Color:
-        shader += blendModeColor;
-        break;
-    case Mode::ColorBurn:
-        shader += blendModeColorBurn;
-        break;
-    case Mode::ColorDodge:
-        shader += blendModeColorDodge;
-        break;
-    case Mode::Darken:
-        shader += blendModeDarken;
-        break;
-    case Mode::DarkerColor:
-        shader += blendModeDarkerColor;
-        break;
-    case Mode::Difference:
-        shader += blendModeDifference;
-        break;
-    case Mode::Divide:
-        shader += blendModeDivide;
-        break;
-    case Mode::Exclusion:
-        shader += blendModeExclusion;
-        break;
-    case Mode::HardLight:
-        shader += blendModeHardLight;
-        break;
-    case Mode::Hue:
-        shader += blendModeHue;
-        break;
-    case Mode::Lighten:
-        shader += blendModeLighten;
-        break;
-    case Mode::LighterColor:
-        shader += blendModeLighterColor;
-        break;
-    case Mode::Lightness:
-        shader += blendModeLightness;
-        break;
-    case Mode::Negation:
-        shader += blendModeNegation;
-        break;
-    case Mode::Normal:
-        shader += blendModeNormal;
-        break;
-    case Mode::Multiply:
-        shader += blendModeMultiply;
-        break;
-    case Mode::Saturation:
-        shader += blendModeSaturation;
-        break;
-    case Mode::Screen:
-        shader += blendModeScreen;
-        break;
-    case Mode::Subtract:
-        shader += blendModeSubtract;
-        break;
-    case Mode::SoftLight:
-        shader += blendModeSoftLight;
-        break;
-    }
-    shader += fragmentShaderEnd;
-    return shader;
+    return QGfxShaderBuilder::shaderSource(u"blend.frag"_qs, {
+        "QGFX_BLEND_MODE "_qba + QByteArray::number(int(mode)),
+        "QGFX_OPAQUE_BACKGROUND "_qba + QByteArray::number(int(opaqueBackground)),
+        "QGFX_OPAQUE_FOREGROUND "_qba + QByteArray::number(int(opaqueForeground)),
+        "QGFX_SOLID_FOREGROUND "_qba + QByteArray::number(int(solidForeground))
+    });
 }
 
 QuickBlend::QuickBlend(QQuickItem *parent)
@@ -321,7 +295,12 @@ void QuickBlend::setBackground(QQuickItem *item)
     }
     d->m_background = item;
     d->m_backgroundSourceProxy->setInput(d->m_background);
+    QObject::disconnect(d->m_backgroundOpaqueConnection);
+    d->m_backgroundOpaqueConnection = QGfxSourceProxy::connectOpaqueChanged(d->m_background, this, "opaqueChanged()");
+    QObject::disconnect(d->m_backgroundContentConnection);
+    d->m_backgroundContentConnection = QGfxSourceProxy::connectContentChanged(d->m_background, d, "invalidate()");
     Q_EMIT backgroundChanged();
+    Q_EMIT opaqueChanged();
 }
 
 QQuickItem *QuickBlend::foreground() const
@@ -341,10 +320,37 @@ void QuickBlend::setForeground(QQuickItem *item)
         return;
     }
     d->m_foreground = item;
-    d->m_foregroundSourceProxy->setInput(d->m_foreground);
+    d->trackForegroundRectangle();
+    d->updateSolidForeground();
+    QObject::disconnect(d->m_foregroundOpaqueConnection);
+    d->m_foregroundOpaqueConnection = QGfxSourceProxy::connectOpaqueChanged(d->m_foreground, d, "scheduleRebuild()");
+    QObject::disconnect(d->m_foregroundContentConnection);
+    d->m_foregroundContentConnection = QGfxSourceProxy::connectContentChanged(d->m_foreground, d, "invalidate()");
     Q_EMIT foregroundChanged();
 }
 
+QColor QuickBlend::foregroundColor() const
+{
+    Q_D(const QuickBlend);
+    return d->m_foregroundColor;
+}
+
+void QuickBlend::setForegroundColor(const QColor &color)
+{
+    Q_D(QuickBlend);
+    if (d->m_foregroundColor == color) {
+        return;
+    }
+    d->m_foregroundColor = color;
+    d->updateSolidForeground();
+    Q_EMIT foregroundColorChanged();
+}
+
+void QuickBlend::resetForegroundColor()
+{
+    setForegroundColor({});
+}
+
 QuickBlend::Mode QuickBlend::mode() const
 {
     Q_D(const QuickBlend);
@@ -376,5 +382,35 @@ void QuickBlend::setCached(const bool value)
     d->m_cached = value;
     d->m_cacheItem->setHideSource(d->m_cached);
     d->m_cacheItem->setVisible(d->m_cached);
+    if (d->m_cached) {
+        d->m_cacheItem->scheduleUpdate();
+    }
     Q_EMIT cachedChanged();
 }
+
+bool QuickBlend::isReady() const
+{
+    Q_D(const QuickBlend);
+    return d->m_ready;
+}
+
+bool QuickBlend::isOpaque() const
+{
+    Q_D(const QuickBlend);
+    return QGfxSourceProxy::isOpaque(d->m_background);
+}
+
+void QuickBlend::markDirty()
+{
+    Q_D(QuickBlend);
+    d->invalidate();
+}
+
+void QuickBlend::updatePolish()
+{
+    QQuickItem::updatePolish();
+    Q_D(QuickBlend);
+    if (d->m_rebuildScheduled) {
+        d->buildFragmentShader();
+    }
+}
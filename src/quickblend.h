@@ -26,6 +26,7 @@
 
 #include "qtacrylicmaterial_global.h"
 #include <QtQml/qqmlregistration.h>
+#include <QtGui/qcolor.h>
 #include <QtQuick/qquickitem.h>
 
 class QuickBlendPrivate;
@@ -39,8 +40,11 @@ class QTACRYLICMATERIAL_API QuickBlend : public QQuickItem
 
     Q_PROPERTY(QQuickItem* background READ background WRITE setBackground NOTIFY backgroundChanged FINAL)
     Q_PROPERTY(QQuickItem* foreground READ foreground WRITE setForeground NOTIFY foregroundChanged FINAL)
+    Q_PROPERTY(QColor foregroundColor READ foregroundColor WRITE setForegroundColor RESET resetForegroundColor NOTIFY foregroundColorChanged FINAL)
     Q_PROPERTY(Mode mode READ mode WRITE setMode NOTIFY modeChanged FINAL)
     Q_PROPERTY(bool cached READ isCached WRITE setCached NOTIFY cachedChanged FINAL)
+    Q_PROPERTY(bool ready READ isReady NOTIFY readyChanged FINAL)
+    Q_PROPERTY(bool opaque READ isOpaque NOTIFY opaqueChanged FINAL)
 
 public:
     enum class Mode
@@ -61,17 +65,41 @@ public:
     [[nodiscard]] QQuickItem *foreground() const;
     void setForeground(QQuickItem *item);
 
+    // A foreground of a single color, takes precedence over the foreground item.
+    // It's passed to the shader directly instead of being rendered into a texture
+    // first. Rectangles without border, radius and children are used the same
+    // way, but changes of their gradient are not noticed.
+    [[nodiscard]] QColor foregroundColor() const;
+    void setForegroundColor(const QColor &color);
+    void resetForegroundColor();
+
     [[nodiscard]] Mode mode() const;
     void setMode(const Mode value);
 
+    // Same as GaussianBlur::cached, the result is only rendered again when the
+    // mode, the size or the content of one of the inputs change.
     [[nodiscard]] bool isCached() const;
     void setCached(const bool value);
 
+    [[nodiscard]] bool isReady() const;
+
+    // Blending anything onto an opaque background gives an opaque result.
+    [[nodiscard]] bool isOpaque() const;
+
+    Q_INVOKABLE void markDirty();
+
+protected:
+    void updatePolish() override;
+
 Q_SIGNALS:
     void backgroundChanged();
     void foregroundChanged();
+    void foregroundColorChanged();
     void modeChanged();
     void cachedChanged();
+    void readyChanged();
+    void opaqueChanged();
+    void contentChanged();
 
 private:
     QScopedPointer<QuickBlendPrivate> d_ptr;
@@ -27,10 +27,12 @@
 #include "qtacrylicmaterial_global.h"
 #include "quickblend.h"
 #include <QtCore/qobject.h>
+#include <QtGui/qcolor.h>
+#include <QtGui/qvector3d.h>
+#include <optional>
 
 QT_BEGIN_NAMESPACE
 class QGfxSourceProxy;
-class QGfxShaderBuilder;
 class QQuickShaderEffectSource;
 class QQuickShaderEffect;
 QT_END_NAMESPACE
@@ -50,20 +52,38 @@ public:
     [[nodiscard]] static QuickBlendPrivate *get(QuickBlend *pub);
     [[nodiscard]] static const QuickBlendPrivate *get(const QuickBlend *pub);
 
+    // Also used by QuickBlendStack for its color layers.
+    [[nodiscard]] static QVector3D rgbToHsl(const QColor &color);
+
 public Q_SLOTS:
+    void scheduleRebuild();
     void buildFragmentShader();
+    void invalidate();
+    void updateSolidForeground();
 
 private:
     void initialize();
-    [[nodiscard]] QByteArray generateShaderCode(const Mode mode) const;
+    void setReady(const bool value);
+    void trackForegroundRectangle();
+    [[nodiscard]] std::optional<QColor> solidForegroundColor() const;
+    [[nodiscard]] static QByteArray generateShaderCode(const Mode mode, const bool opaqueBackground, const bool opaqueForeground, const bool solidForeground);
 
 private:
     QuickBlend *q_ptr = nullptr;
     QQuickItem *m_background = nullptr;
     QQuickItem *m_foreground = nullptr;
+    QColor m_foregroundColor = {};
+    bool m_solidForeground = false;
     Mode m_mode = Mode::Normal;
     bool m_cached = false;
-    QScopedPointer<QGfxShaderBuilder> m_shaderBuilder;
+    bool m_ready = false;
+    bool m_rebuildScheduled = false;
+    quint64 m_shaderGeneration = 0;
+    QMetaObject::Connection m_backgroundOpaqueConnection = {};
+    QMetaObject::Connection m_foregroundOpaqueConnection = {};
+    QMetaObject::Connection m_backgroundContentConnection = {};
+    QMetaObject::Connection m_foregroundContentConnection = {};
+    QList<QMetaObject::Connection> m_foregroundRectangleConnections = {};
     QScopedPointer<QGfxSourceProxy> m_backgroundSourceProxy;
     QScopedPointer<QGfxSourceProxy> m_foregroundSourceProxy;
     QScopedPointer<QQuickShaderEffectSource> m_cacheItem;
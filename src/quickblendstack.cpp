@@ -0,0 +1,621 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2022 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "quickblendstack.h"
+#include "quickblendstack_p.h"
+#include "quickblend_p.h"
+#include "qgfxsourceproxy_p.h"
+#include "qgfxshaderbuilder_p.h"
+#include <QtCore/qfuturewatcher.h>
+#include <QtQuick/private/qquickshadereffect_p.h>
+#include <QtQuick/private/qquickshadereffectsource_p.h>
+#include <QtQuick/private/qquickanchors_p.h>
+
+// 16 samplers is the lowest limit among the backends, one is the background.
+static constexpr const int sc_maximumTexturedLayers = 15;
+
+[[nodiscard]] static inline QByteArray qgfx_blendShaderSection(const QByteArray &source, const QByteArray &name)
+{
+    const QByteArray beginMarker = "// "_qba + name + "_BEGIN"_qba;
+    const QByteArray endMarker = "// "_qba + name + "_END"_qba;
+    const qsizetype beginIndex = source.indexOf(beginMarker);
+    const qsizetype endIndex = source.indexOf(endMarker, beginIndex);
+    if ((beginIndex < 0) || (endIndex < 0)) {
+        qWarning() << "QuickBlendStack: Can't find" << name << "in blend.frag";
+        return {};
+    }
+    const qsizetype sectionIndex = (beginIndex + beginMarker.size());
+    return source.mid(sectionIndex, endIndex - sectionIndex);
+}
+
+[[nodiscard]] static inline bool qgfx_usesForegroundHsl(const int mode)
+{
+    // The modes which use QGFX_FOREGROUND_HSL or QGFX_FOREGROUND_L in blend.frag.
+    switch (QuickBlend::Mode(mode)) {
+    case QuickBlend::Mode::Color:
+    case QuickBlend::Mode::Hue:
+    case QuickBlend::Mode::Lightness:
+    case QuickBlend::Mode::Saturation:
+        return true;
+    default:
+        break;
+    }
+    return false;
+}
+
+QuickBlendLayer::QuickBlendLayer(QObject *parent) : QObject(parent)
+{
+}
+
+QuickBlendLayer::~QuickBlendLayer() = default;
+
+QQuickItem *QuickBlendLayer::source() const
+{
+    return m_source;
+}
+
+void QuickBlendLayer::setSource(QQuickItem *item)
+{
+    if (m_source == item) {
+        return;
+    }
+    if (m_source) {
+        disconnect(m_source, nullptr, this, nullptr);
+    }
+    m_source = item;
+    if (m_source) {
+        // The stack has to drop the layer, source() is null by then.
+        connect(m_source, &QObject::destroyed, this, &QuickBlendLayer::sourceChanged);
+    }
+    Q_EMIT sourceChanged();
+}
+
+QColor QuickBlendLayer::color() const
+{
+    return m_color;
+}
+
+void QuickBlendLayer::setColor(const QColor &value)
+{
+    if (m_color == value) {
+        return;
+    }
+    m_color = value;
+    Q_EMIT colorChanged();
+}
+
+void QuickBlendLayer::resetColor()
+{
+    setColor({});
+}
+
+QuickBlend::Mode QuickBlendLayer::mode() const
+{
+    return m_mode;
+}
+
+void QuickBlendLayer::setMode(const QuickBlend::Mode value)
+{
+    if (m_mode == value) {
+        return;
+    }
+    m_mode = value;
+    Q_EMIT modeChanged();
+}
+
+qreal QuickBlendLayer::opacity() const
+{
+    return m_opacity;
+}
+
+void QuickBlendLayer::setOpacity(const qreal value)
+{
+    const qreal opacity = qBound(0.0, value, 1.0);
+    if (qFuzzyCompare(m_opacity, opacity)) {
+        return;
+    }
+    m_opacity = opacity;
+    Q_EMIT opacityChanged();
+}
+
+QuickBlendStackPrivate::QuickBlendStackPrivate(QuickBlendStack *q) : QObject(q)
+{
+    Q_ASSERT(q);
+    if (!q) {
+        return;
+    }
+    q_ptr = q;
+    initialize();
+}
+
+QuickBlendStackPrivate::~QuickBlendStackPrivate()
+{
+    qDeleteAll(m_layerSourceProxies);
+}
+
+QuickBlendStackPrivate *QuickBlendStackPrivate::get(QuickBlendStack *pub)
+{
+    Q_ASSERT(pub);
+    if (!pub) {
+        return nullptr;
+    }
+    return pub->d_func();
+}
+
+const QuickBlendStackPrivate *QuickBlendStackPrivate::get(const QuickBlendStack *pub)
+{
+    Q_ASSERT(pub);
+    if (!pub) {
+        return nullptr;
+    }
+    return pub->d_func();
+}
+
+void QuickBlendStackPrivate::scheduleRebuild()
+{
+    // See QuickBlendPrivate::scheduleRebuild().
+    if (m_rebuildScheduled) {
+        QGfxShaderCache::instance()->recordAvoidedRebuild();
+        return;
+    }
+    m_rebuildScheduled = true;
+    Q_Q(QuickBlendStack);
+    q->polish();
+}
+
+void QuickBlendStackPrivate::buildFragmentShader()
+{
+    m_rebuildScheduled = false;
+    updateActiveLayers();
+    m_shaderItem->setProperty("source", QVariant::fromValue(m_backgroundSourceProxy->output()));
+    qsizetype texturedIndex = 0;
+    for (qsizetype i = 0; i != m_activeLayers.size(); ++i) {
+        if (m_activeLayers.at(i)->color().isValid()) {
+            continue;
+        }
+        const QGfxSourceProxy * const proxy = m_layerSourceProxies.at(texturedIndex++);
+        const QByteArray name = ("layerSource"_qba + QByteArray::number(i));
+        m_shaderItem->setProperty(name.constData(), QVariant::fromValue(proxy->output()));
+    }
+    updateLayerUniforms();
+    // Every combination of modes is possible, so nothing is prebaked. The cache
+    // key carries the whole sequence, stacks which only differ in their colors,
+    // sources and opacities share the shader.
+    const quint64 generation = ++m_shaderGeneration;
+    const QByteArray signature = layerSignature();
+    const bool opaqueBackground = QGfxSourceProxy::isOpaque(m_background);
+    QGfxShaderKey key = {};
+    key.blendLayers = signature;
+    key.opaque = opaqueBackground;
+    key.backend = QGfxShaderBuilder::graphicsApi();
+    const QFuture<QUrl> future = QGfxShaderBuilder::fragmentShaderAsync(key, [signature, opaqueBackground](){
+        return generateShaderCode(signature, opaqueBackground);
+    });
+    if (future.isFinished()) {
+        const QUrl fragmentShaderUrl = future.result();
+        m_shaderItem->setFragmentShader(fragmentShaderUrl);
+        setReady(!fragmentShaderUrl.isEmpty());
+        invalidate();
+        return;
+    }
+    setReady(false);
+    const auto watcher = new QFutureWatcher<QUrl>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, generation](){
+        watcher->deleteLater();
+        if (generation != m_shaderGeneration) {
+            return;
+        }
+        const QUrl fragmentShaderUrl = watcher->result();
+        m_shaderItem->setFragmentShader(fragmentShaderUrl);
+        setReady(!fragmentShaderUrl.isEmpty());
+        invalidate();
+    });
+    watcher->setFuture(future);
+}
+
+void QuickBlendStackPrivate::invalidate()
+{
+    // See QuickGaussianBlurPrivate::invalidate().
+    if (m_cached) {
+        m_cacheItem->scheduleUpdate();
+    }
+    Q_Q(QuickBlendStack);
+    Q_EMIT q->contentChanged();
+}
+
+void QuickBlendStackPrivate::updateLayerUniforms()
+{
+    for (qsizetype i = 0; i != m_activeLayers.size(); ++i) {
+        const QuickBlendLayer * const layer = m_activeLayers.at(i);
+        const QByteArray index = QByteArray::number(i);
+        const QByteArray opacityName = ("layerOpacity"_qba + index);
+        m_shaderItem->setProperty(opacityName.constData(), layer->opacity());
+        if (m_colorLayers.contains(layer)) {
+            const QByteArray colorName = ("layerColor"_qba + index);
+            m_shaderItem->setProperty(colorName.constData(), layer->color());
+            // Saves the shader from converting the same color for every pixel.
+            if (qgfx_usesForegroundHsl(int(layer->mode()))) {
+                const QByteArray hslName = ("layerHSL"_qba + index);
+                m_shaderItem->setProperty(hslName.constData(), QuickBlendPrivate::rgbToHsl(layer->color()));
+            }
+        }
+    }
+    invalidate();
+}
+
+void QuickBlendStackPrivate::setReady(const bool value)
+{
+    if (m_ready == value) {
+        return;
+    }
+    m_ready = value;
+    Q_Q(QuickBlendStack);
+    Q_EMIT q->readyChanged();
+}
+
+void QuickBlendStackPrivate::appendLayer(QuickBlendLayer *layer)
+{
+    Q_ASSERT(layer);
+    if (!layer) {
+        return;
+    }
+    m_layers.append(layer);
+    connect(layer, &QuickBlendLayer::sourceChanged, this, &QuickBlendStackPrivate::scheduleRebuild);
+    connect(layer, &QuickBlendLayer::modeChanged, this, &QuickBlendStackPrivate::scheduleRebuild);
+    connect(layer, &QuickBlendLayer::colorChanged, this, [this, layer](){
+        updateLayerColor(layer);
+    });
+    connect(layer, &QuickBlendLayer::opacityChanged, this, &QuickBlendStackPrivate::updateLayerUniforms);
+    connect(layer, &QObject::destroyed, this, [this, layer](){
+        removeLayer(layer);
+    });
+    scheduleRebuild();
+    Q_Q(QuickBlendStack);
+    Q_EMIT q->layersChanged();
+}
+
+void QuickBlendStackPrivate::removeLayer(QuickBlendLayer *layer)
+{
+    if (!m_layers.removeAll(layer)) {
+        return;
+    }
+    m_activeLayers.removeAll(layer);
+    m_colorLayers.removeAll(layer);
+    disconnect(layer, nullptr, this, nullptr);
+    scheduleRebuild();
+    Q_Q(QuickBlendStack);
+    Q_EMIT q->layersChanged();
+}
+
+void QuickBlendStackPrivate::clearLayers()
+{
+    if (m_layers.isEmpty()) {
+        return;
+    }
+    for (auto &&layer : std::as_const(m_layers)) {
+        disconnect(layer, nullptr, this, nullptr);
+    }
+    m_layers.clear();
+    m_activeLayers.clear();
+    m_colorLayers.clear();
+    scheduleRebuild();
+    Q_Q(QuickBlendStack);
+    Q_EMIT q->layersChanged();
+}
+
+void QuickBlendStackPrivate::updateActiveLayers()
+{
+    for (auto &&connection : std::as_const(m_layerContentConnections)) {
+        disconnect(connection);
+    }
+    m_layerContentConnections.clear();
+    m_activeLayers.clear();
+    m_colorLayers.clear();
+    Q_Q(QuickBlendStack);
+    qsizetype texturedCount = 0;
+    for (auto &&layer : std::as_const(m_layers)) {
+        if (layer->color().isValid()) {
+            m_activeLayers.append(layer);
+            m_colorLayers.append(layer);
+            continue;
+        }
+        if (!layer->source()) {
+            continue;
+        }
+        if (texturedCount >= sc_maximumTexturedLayers) {
+            qWarning() << "QuickBlendStack: Too many layers with a source, ignoring" << layer;
+            continue;
+        }
+        if (texturedCount >= m_layerSourceProxies.size()) {
+            const auto proxy = new QGfxSourceProxy(q);
+            connect(proxy, &QGfxSourceProxy::outputChanged, this, &QuickBlendStackPrivate::scheduleRebuild);
+            m_layerSourceProxies.append(proxy);
+        }
+        m_layerSourceProxies.at(texturedCount++)->setInput(layer->source());
+        m_layerContentConnections.append(QGfxSourceProxy::connectContentChanged(layer->source(), this, "invalidate()"));
+        m_activeLayers.append(layer);
+    }
+    // Drop the offscreen copies nobody needs anymore.
+    while (m_layerSourceProxies.size() > texturedCount) {
+        delete m_layerSourceProxies.takeLast();
+    }
+}
+
+void QuickBlendStackPrivate::updateLayerColor(QuickBlendLayer *layer)
+{
+    Q_ASSERT(layer);
+    if (!layer) {
+        return;
+    }
+    // Only a color becoming valid or invalid changes the shader, anything else
+    // is a uniform.
+    if (layer->color().isValid() != m_colorLayers.contains(layer)) {
+        scheduleRebuild();
+    } else {
+        updateLayerUniforms();
+    }
+}
+
+QByteArray QuickBlendStackPrivate::layerSignature() const
+{
+    // "stack", then a 't' (textured) or 'c' (color) and the mode for every layer.
+    QByteArray signature = "stack"_qba;
+    for (auto &&layer : std::as_const(m_activeLayers)) {
+        signature += ':';
+        signature += (m_colorLayers.contains(layer) ? 'c' : 't');
+        signature += QByteArray::number(int(layer->mode()));
+    }
+    return signature;
+}
+
+void QuickBlendStackPrivate::initialize()
+{
+    Q_Q(QuickBlendStack);
+    connect(q, &QuickBlendStack::opaqueChanged, this, &QuickBlendStackPrivate::scheduleRebuild);
+    connect(q, &QuickBlendStack::widthChanged, this, &QuickBlendStackPrivate::invalidate);
+    connect(q, &QuickBlendStack::heightChanged, this, &QuickBlendStackPrivate::invalidate);
+
+    m_backgroundSourceProxy.reset(new QGfxSourceProxy(q));
+    connect(m_backgroundSourceProxy.get(), &QGfxSourceProxy::outputChanged, this, &QuickBlendStackPrivate::scheduleRebuild);
+    m_shaderItem.reset(new QQuickShaderEffect(q));
+    const auto shaderItemAnchors = new QQuickAnchors(m_shaderItem.get(), m_shaderItem.get());
+    shaderItemAnchors->setFill(q);
+    m_cacheItem.reset(new QQuickShaderEffectSource(q));
+    const auto cacheItemAnchors = new QQuickAnchors(m_cacheItem.get(), m_cacheItem.get());
+    cacheItemAnchors->setFill(q);
+    m_cacheItem->setSmooth(true);
+    m_cacheItem->setSourceItem(m_shaderItem.get());
+    m_cacheItem->setLive(false);
+    m_cacheItem->setHideSource(m_cached);
+    m_cacheItem->setVisible(m_cached);
+
+    scheduleRebuild();
+}
+
+QByteArray QuickBlendStackPrivate::generateShaderCode(const QByteArray &signature, const bool opaqueBackground)
+{
+    const QByteArray blendSource = QGfxShaderBuilder::shaderSource(u"blend.frag"_qs);
+    const QByteArrayList layers = signature.split(':').mid(1);
+
+    QByteArray uniforms = {};
+    QByteArray samplers = {};
+    QByteArray blendFunctions = {};
+    QByteArray layerCode = {};
+    QList<int> modes = {};
+    int binding = 2;
+    for (qsizetype i = 0; i != layers.size(); ++i) {
+        const QByteArray &layer = layers.at(i);
+        const bool textured = layer.startsWith('t');
+        const int mode = layer.mid(1).toInt();
+        const QByteArray index = QByteArray::number(i);
+        const QByteArray modeName = QByteArray::number(mode);
+        uniforms += "    float layerOpacity"_qba + index + ";\n"_qba;
+        if (textured) {
+            samplers += "layout(binding = "_qba + QByteArray::number(binding++)
+                        + ") uniform sampler2D layerSource"_qba + index + ";\n"_qba;
+            layerCode += "    color2 = layerOpacity"_qba + index + " * texture(layerSource"_qba + index + ", qt_TexCoord0);\n"_qba;
+        } else {
+            uniforms += "    vec4 layerColor"_qba + index + ";\n"_qba;
+            layerCode += "    color2 = layerOpacity"_qba + index + " * layerColor"_qba + index + ";\n"_qba;
+        }
+        // A color layer takes the HSL of its color from a uniform, like Blend does
+        // for a solid foreground, so it gets an instance of the function of its own.
+        const bool solidHsl = (!textured && qgfx_usesForegroundHsl(mode));
+        const QByteArray functionName = ("qgfx_blend_"_qba + modeName + (solidHsl ? ("_"_qba + index) : QByteArray()));
+        layerCode += "    rgb2 = color2.rgb / max(1.0/256.0, color2.a);\n"_qba
+                     "    rgb1 = mix(rgb1, "_qba + functionName + "(rgb1, rgb2), color2.a);\n"_qba;
+        // Only the normal mode covers the background, the others blend into it.
+        if (!opaqueBackground && (mode == int(QuickBlend::Mode::Normal))) {
+            layerCode += "    a = max(a, color2.a);\n"_qba;
+        }
+        if (solidHsl) {
+            uniforms += "    vec3 layerHSL"_qba + index + ";\n"_qba;
+            // Put back what the helpers define without QGFX_SOLID_FOREGROUND afterwards.
+            blendFunctions += "#undef QGFX_FOREGROUND_HSL\n"_qba
+                              "#undef QGFX_FOREGROUND_L\n"_qba
+                              "#define QGFX_FOREGROUND_HSL layerHSL"_qba + index + "\n"_qba
+                              "#define QGFX_FOREGROUND_L layerHSL"_qba + index + ".z\n"_qba
+                              "#define QGFX_BLEND_MODE "_qba + modeName + "\n"_qba
+                              "#define qgfx_blend "_qba + functionName
+                              + qgfx_blendShaderSection(blendSource, "QGFX_BLEND_FUNCTION"_qba)
+                              + "#undef qgfx_blend\n"_qba
+                              "#undef QGFX_BLEND_MODE\n"_qba
+                              "#undef QGFX_FOREGROUND_HSL\n"_qba
+                              "#undef QGFX_FOREGROUND_L\n"_qba
+                              "#define QGFX_FOREGROUND_HSL RGBtoHSL(rgb2)\n"_qba
+                              "#define QGFX_FOREGROUND_L RGBtoL(rgb2)\n"_qba;
+        } else if (!modes.contains(mode)) {
+            modes.append(mode);
+            blendFunctions += "#define QGFX_BLEND_MODE "_qba + modeName + "\n"_qba
+                              "#define qgfx_blend "_qba + functionName
+                              + qgfx_blendShaderSection(blendSource, "QGFX_BLEND_FUNCTION"_qba)
+                              + "#undef qgfx_blend\n"_qba
+                              "#undef QGFX_BLEND_MODE\n"_qba;
+        }
+    }
+
+    QByteArray code = "#version 440\n\n"_qba;
+    // The helpers use it to pick where the foreground's HSL comes from.
+    code += "#define QGFX_SOLID_FOREGROUND 0\n\n"_qba;
+    code += "layout(location = 0) in vec2 qt_TexCoord0;\n"_qba;
+    code += "layout(location = 0) out vec4 fragColor;\n\n"_qba;
+    code += "layout(std140, binding = 0) uniform buf {\n"_qba;
+    code += "    mat4 qt_Matrix;\n"_qba;
+    code += "    float qt_Opacity;\n"_qba;
+    code += uniforms;
+    code += "};\n"_qba;
+    code += "layout(binding = 1) uniform sampler2D source;\n"_qba;
+    code += samplers;
+    code += qgfx_blendShaderSection(blendSource, "QGFX_BLEND_HELPERS"_qba);
+    code += blendFunctions;
+    code += "\nvoid main() {\n"_qba;
+    code += "    vec4 color1 = texture(source, qt_TexCoord0);\n"_qba;
+    if (opaqueBackground) {
+        code += "    vec3 rgb1 = color1.rgb;\n"_qba;
+        code += "    float a = 1.0;\n"_qba;
+    } else {
+        code += "    vec3 rgb1 = color1.rgb / max(1.0/256.0, color1.a);\n"_qba;
+        code += "    float a = color1.a;\n"_qba;
+    }
+    code += "    vec4 color2;\n"_qba;
+    code += "    vec3 rgb2;\n"_qba;
+    code += layerCode;
+    code += "    fragColor = qt_Opacity * vec4(rgb1 * a, a);\n"_qba;
+    code += "}\n"_qba;
+    return code;
+}
+
+void QuickBlendStackPrivate::layersAppend(QQmlListProperty<QuickBlendLayer> *list, QuickBlendLayer *layer)
+{
+    static_cast<QuickBlendStackPrivate *>(list->data)->appendLayer(layer);
+}
+
+qsizetype QuickBlendStackPrivate::layersCount(QQmlListProperty<QuickBlendLayer> *list)
+{
+    return static_cast<QuickBlendStackPrivate *>(list->data)->m_layers.size();
+}
+
+QuickBlendLayer *QuickBlendStackPrivate::layersAt(QQmlListProperty<QuickBlendLayer> *list, qsizetype index)
+{
+    return static_cast<QuickBlendStackPrivate *>(list->data)->m_layers.value(index);
+}
+
+void QuickBlendStackPrivate::layersClear(QQmlListProperty<QuickBlendLayer> *list)
+{
+    static_cast<QuickBlendStackPrivate *>(list->data)->clearLayers();
+}
+
+QuickBlendStack::QuickBlendStack(QQuickItem *parent)
+    : QQuickItem(parent), d_ptr(new QuickBlendStackPrivate(this))
+{
+}
+
+QuickBlendStack::~QuickBlendStack() = default;
+
+QQuickItem *QuickBlendStack::background() const
+{
+    Q_D(const QuickBlendStack);
+    return d->m_background;
+}
+
+void QuickBlendStack::setBackground(QQuickItem *item)
+{
+    Q_ASSERT(item);
+    if (!item) {
+        return;
+    }
+    Q_D(QuickBlendStack);
+    if (d->m_background == item) {
+        return;
+    }
+    d->m_background = item;
+    d->m_backgroundSourceProxy->setInput(d->m_background);
+    QObject::disconnect(d->m_backgroundOpaqueConnection);
+    d->m_backgroundOpaqueConnection = QGfxSourceProxy::connectOpaqueChanged(d->m_background, this, "opaqueChanged()");
+    QObject::disconnect(d->m_backgroundContentConnection);
+    d->m_backgroundContentConnection = QGfxSourceProxy::connectContentChanged(d->m_background, d, "invalidate()");
+    Q_EMIT backgroundChanged();
+    Q_EMIT opaqueChanged();
+}
+
+QQmlListProperty<QuickBlendLayer> QuickBlendStack::layers()
+{
+    Q_D(QuickBlendStack);
+    return QQmlListProperty<QuickBlendLayer>(this, d,
+        &QuickBlendStackPrivate::layersAppend, &QuickBlendStackPrivate::layersCount,
+        &QuickBlendStackPrivate::layersAt, &QuickBlendStackPrivate::layersClear);
+}
+
+int QuickBlendStack::maximumTexturedLayers()
+{
+    return sc_maximumTexturedLayers;
+}
+
+bool QuickBlendStack::isCached() const
+{
+    Q_D(const QuickBlendStack);
+    return d->m_cached;
+}
+
+void QuickBlendStack::setCached(const bool value)
+{
+    Q_D(QuickBlendStack);
+    if (d->m_cached == value) {
+        return;
+    }
+    d->m_cached = value;
+    d->m_cacheItem->setHideSource(d->m_cached);
+    d->m_cacheItem->setVisible(d->m_cached);
+    if (d->m_cached) {
+        d->m_cacheItem->scheduleUpdate();
+    }
+    Q_EMIT cachedChanged();
+}
+
+bool QuickBlendStack::isReady() const
+{
+    Q_D(const QuickBlendStack);
+    return d->m_ready;
+}
+
+bool QuickBlendStack::isOpaque() const
+{
+    Q_D(const QuickBlendStack);
+    return QGfxSourceProxy::isOpaque(d->m_background);
+}
+
+void QuickBlendStack::markDirty()
+{
+    Q_D(QuickBlendStack);
+    d->invalidate();
+}
+
+void QuickBlendStack::updatePolish()
+{
+    QQuickItem::updatePolish();
+    Q_D(QuickBlendStack);
+    if (d->m_rebuildScheduled) {
+        d->buildFragmentShader();
+    }
+}
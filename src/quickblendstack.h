@@ -0,0 +1,136 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2022 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "qtacrylicmaterial_global.h"
+#include "quickblend.h"
+#include <QtQml/qqmlregistration.h>
+#include <QtQml/qqmllist.h>
+#include <QtCore/qpointer.h>
+#include <QtGui/qcolor.h>
+#include <QtQuick/qquickitem.h>
+
+class QuickBlendStackPrivate;
+
+// One layer of a BlendStack. Not an item, it only describes what gets blended.
+class QTACRYLICMATERIAL_API QuickBlendLayer : public QObject
+{
+    Q_OBJECT
+    QML_NAMED_ELEMENT(BlendLayer)
+    Q_DISABLE_COPY_MOVE(QuickBlendLayer)
+
+    Q_PROPERTY(QQuickItem* source READ source WRITE setSource NOTIFY sourceChanged FINAL)
+    Q_PROPERTY(QColor color READ color WRITE setColor RESET resetColor NOTIFY colorChanged FINAL)
+    Q_PROPERTY(QuickBlend::Mode mode READ mode WRITE setMode NOTIFY modeChanged FINAL)
+    Q_PROPERTY(qreal opacity READ opacity WRITE setOpacity NOTIFY opacityChanged FINAL)
+
+public:
+    explicit QuickBlendLayer(QObject *parent = nullptr);
+    ~QuickBlendLayer() override;
+
+    [[nodiscard]] QQuickItem *source() const;
+    void setSource(QQuickItem *item);
+
+    // Same as Blend::foregroundColor, takes precedence over the source.
+    [[nodiscard]] QColor color() const;
+    void setColor(const QColor &value);
+    void resetColor();
+
+    [[nodiscard]] QuickBlend::Mode mode() const;
+    void setMode(const QuickBlend::Mode value);
+
+    // Changing it only updates a uniform, the shader stays the same.
+    [[nodiscard]] qreal opacity() const;
+    void setOpacity(const qreal value);
+
+Q_SIGNALS:
+    void sourceChanged();
+    void colorChanged();
+    void modeChanged();
+    void opacityChanged();
+
+private:
+    QPointer<QQuickItem> m_source = nullptr;
+    QColor m_color = {};
+    QuickBlend::Mode m_mode = QuickBlend::Mode::Normal;
+    qreal m_opacity = 1.0;
+};
+
+// Blends any number of layers onto the background, from the first to the last,
+// in a single pass. The shader is generated for the sequence of modes and layer
+// kinds, changing anything else doesn't rebuild it.
+class QTACRYLICMATERIAL_API QuickBlendStack : public QQuickItem
+{
+    Q_OBJECT
+    QML_NAMED_ELEMENT(BlendStack)
+    Q_DECLARE_PRIVATE(QuickBlendStack)
+    Q_DISABLE_COPY_MOVE(QuickBlendStack)
+    Q_CLASSINFO("DefaultProperty", "layers")
+
+    Q_PROPERTY(QQuickItem* background READ background WRITE setBackground NOTIFY backgroundChanged FINAL)
+    Q_PROPERTY(QQmlListProperty<QuickBlendLayer> layers READ layers NOTIFY layersChanged FINAL)
+    Q_PROPERTY(bool cached READ isCached WRITE setCached NOTIFY cachedChanged FINAL)
+    Q_PROPERTY(bool ready READ isReady NOTIFY readyChanged FINAL)
+    Q_PROPERTY(bool opaque READ isOpaque NOTIFY opaqueChanged FINAL)
+
+public:
+    explicit QuickBlendStack(QQuickItem *parent = nullptr);
+    ~QuickBlendStack() override;
+
+    [[nodiscard]] QQuickItem *background() const;
+    void setBackground(QQuickItem *item);
+
+    // Layers without a source and without a color are skipped. At most
+    // maximumTexturedLayers() of them can use a source, the rest are ignored.
+    [[nodiscard]] QQmlListProperty<QuickBlendLayer> layers();
+    [[nodiscard]] static int maximumTexturedLayers();
+
+    // Same as Blend::cached.
+    [[nodiscard]] bool isCached() const;
+    void setCached(const bool value);
+
+    [[nodiscard]] bool isReady() const;
+
+    [[nodiscard]] bool isOpaque() const;
+
+    Q_INVOKABLE void markDirty();
+
+protected:
+    void updatePolish() override;
+
+Q_SIGNALS:
+    void backgroundChanged();
+    void layersChanged();
+    void cachedChanged();
+    void readyChanged();
+    void opaqueChanged();
+    void contentChanged();
+
+private:
+    QScopedPointer<QuickBlendStackPrivate> d_ptr;
+};
+
+QML_DECLARE_TYPE(QuickBlendLayer)
+QML_DECLARE_TYPE(QuickBlendStack)
@@ -0,0 +1,92 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2022 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "qtacrylicmaterial_global.h"
+#include "quickblendstack.h"
+#include <QtCore/qobject.h>
+
+QT_BEGIN_NAMESPACE
+class QGfxSourceProxy;
+class QQuickShaderEffectSource;
+class QQuickShaderEffect;
+QT_END_NAMESPACE
+
+class QTACRYLICMATERIAL_API QuickBlendStackPrivate : public QObject
+{
+    Q_OBJECT
+    Q_DECLARE_PUBLIC(QuickBlendStack)
+    Q_DISABLE_COPY_MOVE(QuickBlendStackPrivate)
+
+public:
+    explicit QuickBlendStackPrivate(QuickBlendStack *q);
+    ~QuickBlendStackPrivate() override;
+
+    [[nodiscard]] static QuickBlendStackPrivate *get(QuickBlendStack *pub);
+    [[nodiscard]] static const QuickBlendStackPrivate *get(const QuickBlendStack *pub);
+
+public Q_SLOTS:
+    void scheduleRebuild();
+    void buildFragmentShader();
+    void invalidate();
+    void updateLayerUniforms();
+
+private:
+    void initialize();
+    void setReady(const bool value);
+    void appendLayer(QuickBlendLayer *layer);
+    void removeLayer(QuickBlendLayer *layer);
+    void clearLayers();
+    void updateActiveLayers();
+    void updateLayerColor(QuickBlendLayer *layer);
+    [[nodiscard]] QByteArray layerSignature() const;
+    [[nodiscard]] static QByteArray generateShaderCode(const QByteArray &signature, const bool opaqueBackground);
+
+    static void layersAppend(QQmlListProperty<QuickBlendLayer> *list, QuickBlendLayer *layer);
+    [[nodiscard]] static qsizetype layersCount(QQmlListProperty<QuickBlendLayer> *list);
+    [[nodiscard]] static QuickBlendLayer *layersAt(QQmlListProperty<QuickBlendLayer> *list, qsizetype index);
+    static void layersClear(QQmlListProperty<QuickBlendLayer> *list);
+
+private:
+    QuickBlendStack *q_ptr = nullptr;
+    QQuickItem *m_background = nullptr;
+    QList<QuickBlendLayer *> m_layers = {};
+    // The layers which take part in the blend, in the same order.
+    QList<QuickBlendLayer *> m_activeLayers = {};
+    // The active layers which the shader takes as a color.
+    QList<QuickBlendLayer *> m_colorLayers = {};
+    bool m_cached = false;
+    bool m_ready = false;
+    bool m_rebuildScheduled = false;
+    quint64 m_shaderGeneration = 0;
+    QMetaObject::Connection m_backgroundOpaqueConnection = {};
+    QMetaObject::Connection m_backgroundContentConnection = {};
+    QList<QMetaObject::Connection> m_layerContentConnections = {};
+    QScopedPointer<QGfxSourceProxy> m_backgroundSourceProxy;
+    // One for every textured layer among the active ones.
+    QList<QGfxSourceProxy *> m_layerSourceProxies = {};
+    QScopedPointer<QQuickShaderEffectSource> m_cacheItem;
+    QScopedPointer<QQuickShaderEffect> m_shaderItem;
+};
@@ -91,6 +91,7 @@ private:
     QPointer<QuickDesktopWallpaper> m_item = nullptr;
     QSGSimpleTextureNode *m_node = nullptr;
     QPixmap pixmap = {};
+    QRectF m_sourceRect = {};
 
     using WallpaperImageAspectStyle = QuickDesktopWallpaperPrivate::WallpaperImageAspectStyle;
 };
@@ -132,11 +133,9 @@ void WallpaperImageNode::maybeGenerateWallpaperImageCache()
     }
     const WallpaperImageAspectStyle aspectStyle = QuickDesktopWallpaperPrivate::getWallpaperImageAspectStyle();
     QImage buffer(desktopSize, QImage::Format_ARGB32_Premultiplied);
-#ifdef Q_OS_WINDOWS
-    if (aspectStyle == WallpaperImageAspectStyle::Center) {
-        buffer.fill(QColorConstants::Black);
-    }
-#endif
+    // Whatever the image doesn't cover shows the black desktop background, the
+    // wallpaper has to stay opaque.
+    buffer.fill(QColorConstants::Black);
     if ((aspectStyle == WallpaperImageAspectStyle::Stretch)
         || (aspectStyle == WallpaperImageAspectStyle::Fit)
         || (aspectStyle == WallpaperImageAspectStyle::Fill)) {
@@ -164,13 +163,20 @@ void WallpaperImageNode::maybeGenerateWallpaperImageCache()
     painter.drawImage(QPoint(0, 0), buffer);
     m_texture.reset(m_item->window()->createTextureFromImage(pixmap.toImage()));
     m_node->setTexture(m_texture.get());
+    Q_EMIT m_item->contentChanged();
 }
 
 void WallpaperImageNode::maybeUpdateWallpaperImageClipRect()
 {
     const QSizeF itemSize = m_item->size();
+    const QRectF sourceRect = {m_item->mapToGlobal(QPointF(0.0, 0.0)), itemSize};
     m_node->setRect(QRectF(QPointF(0.0, 0.0), itemSize));
-    m_node->setSourceRect(QRectF(m_item->mapToGlobal(QPointF(0.0, 0.0)), itemSize));
+    m_node->setSourceRect(sourceRect);
+    if (m_sourceRect != sourceRect) {
+        m_sourceRect = sourceRect;
+        // Cached effects using us as their source have to catch up.
+        Q_EMIT m_item->contentChanged();
+    }
 }
 
 void WallpaperImageNode::forceRegenerateWallpaperImageCache()
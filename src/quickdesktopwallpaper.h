@@ -37,10 +37,20 @@ class QTACRYLICMATERIAL_API QuickDesktopWallpaper : public QQuickItem
     Q_DECLARE_PRIVATE(QuickDesktopWallpaper)
     Q_DISABLE_COPY_MOVE(QuickDesktopWallpaper)
 
+    // Lets the effects which use the wallpaper as their source pick cheaper shaders.
+    Q_PROPERTY(bool opaque READ isOpaque CONSTANT FINAL)
+
 public:
     explicit QuickDesktopWallpaper(QQuickItem *parent = nullptr);
     ~QuickDesktopWallpaper() override;
 
+    [[nodiscard]] bool isOpaque() const { return true; }
+
+Q_SIGNALS:
+    // A new wallpaper, or another part of it became visible. Emitted from the
+    // render thread when the item moved.
+    void contentChanged();
+
 protected:
     void itemChange(const ItemChange change, const ItemChangeData &value) override;
     [[nodiscard]] QSGNode *updatePaintNode(QSGNode *old, UpdatePaintNodeData *data) override;
@@ -26,10 +26,13 @@
 #include "quickgaussianblur_p.h"
 #include "qgfxsourceproxy_p.h"
 #include "qgfxshaderbuilder_p.h"
+#include "qgfxblurpyramid_p.h"
+#include "qgfxcomputeblurnode_p.h"
+#include "qgfxincrementalblur_p.h"
 #include <QtCore/qmath.h>
+#include <QtCore/qfuturewatcher.h>
 #include <QtGui/qvector2d.h>
 #include <QtGui/qscreen.h>
-#include <QtQml/qqmlengine.h>
 #include <QtQuick/qquickwindow.h>
 #include <QtQuick/private/qquickshadereffect_p.h>
 #include <QtQuick/private/qquickshadereffectsource_p.h>
@@ -43,6 +46,31 @@ static constexpr const char kDeviation[] = "deviation";
 static constexpr const char kColor[] = "color";
 static constexpr const char kThickness[] = "thickness";
 static constexpr const char kMask[] = "mask";
+static constexpr const char kTapCount[] = "tapCount";
+static constexpr const char kCenterWeight[] = "centerWeight";
+static constexpr const char kOffset[] = "offset";
+static constexpr const char kTexelStep[] = "texelStep";
+static constexpr const char kBoxRadius[] = "boxRadius";
+static constexpr const char kDither[] = "dither";
+static constexpr const char kPreviousSource[] = "previousSource";
+static constexpr const char kNextSource[] = "nextSource";
+static constexpr const char kProgress[] = "progress";
+
+// Each iteration halves the resolution once more, 1/32 is small enough.
+static constexpr const int sc_maximumKawaseIterations = 5;
+// The loop in boxblur.frag can't go any further.
+static constexpr const int sc_maximumBoxRadius = 64;
+
+[[nodiscard]] static inline bool qgfx_computeBlurAvailable(const qreal radius)
+{
+#if (QT_VERSION >= QT_VERSION_CHECK(6, 6, 0))
+    return (QGfxShaderBuilder::isComputeSupported() && (qRound(radius) <= QGfxComputeBlurNode::maximumRadius()));
+#else
+    // Render nodes can't record any work outside of the render pass before Qt 6.6.
+    Q_UNUSED(radius);
+    return false;
+#endif
+}
 
 QuickGaussianBlurPrivate::QuickGaussianBlurPrivate(QuickGaussianBlur *q) : QObject(q)
 {
@@ -54,7 +82,13 @@ QuickGaussianBlurPrivate::QuickGaussianBlurPrivate(QuickGaussianBlur *q) : QObje
     initialize();
 }
 
-QuickGaussianBlurPrivate::~QuickGaussianBlurPrivate() = default;
+QuickGaussianBlurPrivate::~QuickGaussianBlurPrivate()
+{
+    // Its context is the window, which may outlive us.
+    if (m_resolveCapabilitiesConnection) {
+        disconnect(m_resolveCapabilitiesConnection);
+    }
+}
 
 QuickGaussianBlurPrivate *QuickGaussianBlurPrivate::get(QuickGaussianBlur *pub)
 {
@@ -74,52 +108,640 @@ const QuickGaussianBlurPrivate *QuickGaussianBlurPrivate::get(const QuickGaussia
     return pub->d_func();
 }
 
-void QuickGaussianBlurPrivate::rebuildShaders()
+void QuickGaussianBlurPrivate::scheduleRebuild()
+{
+    // Collect all the changes and rebuild once, right before the next frame.
+    if (m_rebuildScheduled) {
+        QGfxShaderCache::instance()->recordAvoidedRebuild();
+        return;
+    }
+    m_rebuildScheduled = true;
+    Q_Q(QuickGaussianBlur);
+    q->polish();
+}
+
+void QuickGaussianBlurPrivate::invalidate()
 {
+    if (m_incrementalBlur) {
+        // Announced through reblurred() once it happened.
+        m_incrementalBlur->invalidate();
+        return;
+    }
+    if (isRateLimited()) {
+        // Everything which happens until the next tick is picked up at once.
+        if (m_updateTimer.isActive()) {
+            m_updatePending = true;
+        } else {
+            grabOutput();
+            m_updateTimer.start();
+        }
+        return;
+    }
+    // The cache is not live, it only grabs the passes again when asked to. The
+    // passes themselves are hidden by it and don't render in the meantime.
+    if (m_cached) {
+        m_cacheItem->scheduleUpdate();
+    }
     Q_Q(QuickGaussianBlur);
+    Q_EMIT q->contentChanged();
+}
+
+void QuickGaussianBlurPrivate::rebuildShaders()
+{
+    m_rebuildScheduled = false;
+    m_capabilitiesPending = isWaitingForCapabilities();
+    if (m_capabilitiesPending) {
+        // Whatever is baked with the guaranteed minimum limits would have to be
+        // baked again as soon as the real ones are known, updateCapabilities()
+        // picks the rebuild up again.
+        return;
+    }
 
     m_samples = ((m_samples <= 0) ? 9 : m_samples);
     m_radius = ((m_radius <= 0.0) ? qFloor(qreal(m_samples) / 2.0) : m_radius);
 
     m_deviation = ((m_radius + 1.0) / 3.3333);
-    m_kernelRadius = qMax(0.0, (qreal(m_samples) / 2.0));
+
+    m_computeSupported = QGfxShaderBuilder::isComputeSupported();
+    setComputeActive(m_compute && (effectiveAlgorithm() == Algorithm::Gaussian) && !m_alphaOnly
+                     && !m_maskSource && qgfx_computeBlurAvailable(m_radius));
+    setIncrementalActive(m_incremental && m_source && !m_computeActive && (effectiveAlgorithm() == Algorithm::Gaussian)
+                         && !m_maskSource && (m_intermediateResolution == IntermediateResolution::Full));
+    updateIntermediateFormat();
+    updatePyramid();
+    if (m_computeActive) {
+        // The render node needs nothing but the source, there's nothing to bake.
+        ++m_shaderGeneration;
+        m_maxBlurSamples = QGfxShaderBuilder::maximumBlurSamples();
+        clearPasses();
+        setReady(true);
+        invalidate();
+        return;
+    }
+    if (effectiveAlgorithm() != Algorithm::Gaussian) {
+        rebuildPasses();
+        return;
+    }
+    clearPasses();
+
+    // In pyramid mode a coarser copy of the source is blurred with a proportionally
+    // smaller kernel. The downsampling already blurred the copy a bit, so that
+    // part is taken out of the deviation to end up with the same look.
+    // Reduced intermediate textures are handled the same way, the kernel is
+    // expressed in the texels of the smaller texture.
+    const qreal scale = ((m_pyramidLevel > 0) ? qreal(1 << m_pyramidLevel) : (1.0 / intermediateScale()));
+    m_effectiveRadius = (m_radius / scale);
+    if (m_pyramidLevel > 0) {
+        const qreal variance = ((m_deviation * m_deviation) - QGfxBlurPyramid::addedVariance(m_pyramidLevel));
+        m_effectiveDeviation = (qSqrt(qMax(variance, 1.0)) / scale);
+    } else {
+        m_effectiveDeviation = (m_deviation / scale);
+    }
+    const int effectiveSamples = qMax(1, qRound(qreal(m_samples) / scale));
+    m_kernelRadius = qMax(0.0, (qreal(effectiveSamples) / 2.0));
     m_kernelSize = qRound((m_kernelRadius * 2.0) + 1.0);
 
-    const QVariant spreadVar = (m_radius / m_kernelRadius);
-    const QVariant deviationVar = m_deviation;
+    // The uniform driven kernel doesn't support masks and alpha-only blurs.
+    m_dynamicKernel = ((m_kernelMode == KernelMode::Dynamic) && !m_alphaOnly && !m_maskSource
+                       && (qRound(m_kernelRadius) <= QGfxShaderBuilder::maximumDynamicBlurRadius()));
+
+    QGfxShaderKey key = {};
+    if (m_dynamicKernel) {
+        // The same shaders serve all kernels, only the uniforms change.
+        key.dynamicKernel = true;
+    } else {
+        key.radius = m_kernelRadius;
+        key.deviation = m_effectiveDeviation;
+        key.alphaOnly = m_alphaOnly;
+        key.masked = (m_maskSource != nullptr);
+        key.fallback = !qFuzzyCompare(m_effectiveRadius, m_kernelRadius);
+        key.opaque = QGfxSourceProxy::isOpaque(m_source);
+    }
+    key.maxSamples = QGfxShaderBuilder::maximumBlurSamples();
+    key.backend = QGfxShaderBuilder::graphicsApi();
+    m_maxBlurSamples = key.maxSamples;
+
+    // The uniforms don't depend on the shaders, so spread, deviation, thickness
+    // and the like take effect right away, even if a bake is still pending.
+    applyUniforms();
+
+    // Any request still in flight is outdated from now on.
+    const quint64 generation = ++m_shaderGeneration;
+    const QFuture<QGfxShaderUrls> future = QGfxShaderBuilder::gaussianBlurShadersAsync(key);
+    if (future.isFinished()) {
+        applyShaders(future.result());
+        return;
+    }
+    // Keep rendering with the current shaders until the new ones have been baked.
+    setReady(false);
+    const auto watcher = new QFutureWatcher<QGfxShaderUrls>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, generation](){
+        watcher->deleteLater();
+        if (generation != m_shaderGeneration) {
+            return;
+        }
+        applyShaders(watcher->result());
+    });
+    watcher->setFuture(future);
+}
+
+void QuickGaussianBlurPrivate::applyUniforms()
+{
+    const QVariant spreadVar = (m_effectiveRadius / m_kernelRadius);
+    const QVariant deviationVar = m_effectiveDeviation;
     const QVariant thicknessVar = qMax(0.0, qMin(0.98, (1.0 - (m_thickness * 0.98))));
     const QVariant maskVar = QVariant::fromValue(m_maskSource);
 
     m_horizontalBlur->setProperty(kSource, QVariant::fromValue(m_sourceProxy->output()));
-    m_horizontalBlur->setProperty(kSpread, spreadVar);
-    m_horizontalBlur->setProperty(kDirstep, QVector2D((1.0 / (q->width() * m_dpr)), 0.0));
-    m_horizontalBlur->setProperty(kDeviation, deviationVar);
-    m_horizontalBlur->setProperty(kColor, QColorConstants::White);
-    m_horizontalBlur->setProperty(kThickness, thicknessVar);
-    m_horizontalBlur->setProperty(kMask, maskVar);
-
     m_verticalBlur->setProperty(kSource, QVariant::fromValue(m_horizontalBlur.get()));
-    m_verticalBlur->setProperty(kSpread, spreadVar);
-    m_verticalBlur->setProperty(kDirstep, QVector2D(0.0, (1.0 / (q->height() * m_dpr))));
-    m_verticalBlur->setProperty(kDeviation, deviationVar);
-    m_verticalBlur->setProperty(kColor, QColorConstants::Black);
-    m_verticalBlur->setProperty(kThickness, thicknessVar);
-    m_verticalBlur->setProperty(kMask, maskVar);
-
-    QQmlEngine engine;
-    QJSValue params = engine.newObject();
-    params.setProperty(u"radius"_qs, m_kernelRadius);
-    params.setProperty(u"deviation"_qs, m_deviation);
-    params.setProperty(u"alphaOnly"_qs, m_alphaOnly);
-    params.setProperty(u"masked"_qs, (m_maskSource != nullptr));
-    params.setProperty(u"fallback"_qs, !qFuzzyCompare(m_radius, m_kernelRadius));
-    const QVariantMap shaders = m_shaderBuilder->gaussianBlur(params);
-    const QUrl fragmentShaderUrl = shaders.value(u"fragmentShader"_qs).toUrl();
-    const QUrl vertexShaderUrl = shaders.value(u"vertexShader"_qs).toUrl();
-    m_horizontalBlur->setFragmentShader(fragmentShaderUrl);
-    m_horizontalBlur->setVertexShader(vertexShaderUrl);
-    m_verticalBlur->setFragmentShader(fragmentShaderUrl);
-    m_verticalBlur->setVertexShader(vertexShaderUrl);
+
+    QList<QQuickShaderEffect *> horizontalPasses = {m_horizontalBlur.get()};
+    QList<QQuickShaderEffect *> verticalPasses = {m_verticalBlur.get()};
+    if (m_incrementalBlur) {
+        // The incremental passes take care of their sources by themselves.
+        horizontalPasses.append(m_incrementalBlur->horizontalPass());
+        verticalPasses.append(m_incrementalBlur->verticalPass());
+        updateIncrementalMargin();
+    }
+    for (auto &&pass : std::as_const(horizontalPasses)) {
+        pass->setProperty(kSpread, spreadVar);
+        pass->setProperty(kDeviation, deviationVar);
+        pass->setProperty(kColor, QColorConstants::White);
+        pass->setProperty(kThickness, thicknessVar);
+        pass->setProperty(kMask, maskVar);
+        pass->setProperty(kDither, 0.0);
+    }
+    for (auto &&pass : std::as_const(verticalPasses)) {
+        pass->setProperty(kSpread, spreadVar);
+        pass->setProperty(kDeviation, deviationVar);
+        pass->setProperty(kColor, QColorConstants::Black);
+        pass->setProperty(kThickness, thicknessVar);
+        pass->setProperty(kMask, maskVar);
+        // Pyramid levels are scaled up after the last pass, see IntermediateResolution.
+        pass->setProperty(kDither, ((m_pyramidLevel > 0) ? 0.0 : 1.0));
+    }
+    updateGeometry();
+
+    if (m_dynamicKernel) {
+        const QList<QQuickShaderEffect *> passes = (horizontalPasses + verticalPasses);
+        const QGfxGaussianKernel kernel = QGfxShaderBuilder::linearGaussianKernel(qRound(m_kernelRadius), m_effectiveDeviation);
+        const QVariant tapCountVar = qreal(kernel.tapCount);
+        const QVariant centerWeightVar = kernel.centerWeight;
+        for (auto &&pass : std::as_const(passes)) {
+            pass->setProperty(kTapCount, tapCountVar);
+            pass->setProperty(kCenterWeight, centerWeightVar);
+            for (qsizetype i = 0; i != kernel.vectors.size(); ++i) {
+                const QByteArray name = "kernel"_qba + QByteArray::number(i);
+                pass->setProperty(name.constData(), QVariant::fromValue(kernel.vectors.at(i)));
+            }
+        }
+    }
+}
+
+void QuickGaussianBlurPrivate::applyShaders(const QGfxShaderUrls &shaders)
+{
+    QList<QQuickShaderEffect *> passes = {m_horizontalBlur.get(), m_verticalBlur.get()};
+    if (m_incrementalBlur) {
+        passes.append(m_incrementalBlur->horizontalPass());
+        passes.append(m_incrementalBlur->verticalPass());
+    }
+    // All the passes are switched within the same event loop iteration, so the
+    // scene graph never sees a half updated pipeline.
+    for (auto &&pass : std::as_const(passes)) {
+        pass->setFragmentShader(shaders.fragmentShader);
+        pass->setVertexShader(shaders.vertexShader);
+    }
+
+    setReady(shaders.isValid());
+    invalidate();
+}
+
+void QuickGaussianBlurPrivate::setReady(const bool value)
+{
+    if (m_ready == value) {
+        return;
+    }
+    m_ready = value;
+    // The default shaders would show the unblurred source, so nothing is drawn
+    // until the very first kernel is available.
+    if (m_ready && !m_computeActive) {
+        outputItem()->setVisible(true);
+    }
+    Q_Q(QuickGaussianBlur);
+    Q_EMIT q->readyChanged();
+}
+
+void QuickGaussianBlurPrivate::updateGeometry()
+{
+    // The only things which depend on the geometry, there's no need to touch
+    // the shaders when resizing.
+    Q_Q(QuickGaussianBlur);
+    if (m_computeActive) {
+        // The render node picks up the new size by itself.
+        q->update();
+        return;
+    }
+    // The passes step over the texels of the intermediate textures, which
+    // are bigger than the pixels of the item unless they are in full resolution.
+    const qreal texelScale = (1.0 / intermediateScale());
+    if (!m_passes.isEmpty()) {
+        const QSizeF size = (q->size() * m_dpr);
+        for (qsizetype i = 0; i != m_passes.size(); ++i) {
+            QQuickShaderEffect * const pass = m_passes.at(i);
+            if (m_algorithm == Algorithm::DualKawase) {
+                // Down to level 1 ... n first, then back up to level 0.
+                const int level = int((i < m_kawaseIterations) ? (i + 1) : ((m_passes.size() - 1) - i));
+                const qreal scale = qreal(1 << level);
+                const QSize levelSize(qMax(1, qCeil(size.width() / scale)), qMax(1, qCeil(size.height() / scale)));
+                QQuickItemPrivate::get(pass)->layer()->setTextureSize((level > 0) ? levelSize : QSize());
+                pass->setProperty(kTexelStep, QVector2D((1.0 / levelSize.width()), (1.0 / levelSize.height())));
+            } else {
+                const bool horizontal = ((i % 2) == 0);
+                pass->setProperty(kDirstep, (horizontal ? QVector2D((texelScale / size.width()), 0.0) : QVector2D(0.0, (texelScale / size.height()))));
+                QQuickItemPrivate::get(pass)->layer()->setTextureSize(intermediateTextureSize());
+            }
+        }
+        return;
+    }
+    QQuickItemLayer * const horizontalBlurLayer = QQuickItemPrivate::get(m_horizontalBlur.get())->layer();
+    QQuickItemLayer * const verticalBlurLayer = QQuickItemPrivate::get(m_verticalBlur.get())->layer();
+    if (m_pyramid && (m_pyramidLevel > 0)) {
+        // Both passes run in the resolution of the level, the layer of the
+        // vertical pass scales the result back up.
+        const QSize levelSize = m_pyramid->levelTextureSize(m_pyramidLevel);
+        horizontalBlurLayer->setTextureSize(levelSize);
+        verticalBlurLayer->setTextureSize(levelSize);
+        verticalBlurLayer->setSmooth(true);
+        verticalBlurLayer->setEnabled(true);
+        m_horizontalBlur->setProperty(kDirstep, QVector2D((1.0 / levelSize.width()), 0.0));
+        m_verticalBlur->setProperty(kDirstep, QVector2D(0.0, (1.0 / levelSize.height())));
+        return;
+    }
+    horizontalBlurLayer->setTextureSize(intermediateTextureSize());
+    verticalBlurLayer->setEnabled(false);
+    verticalBlurLayer->setTextureSize({});
+    m_horizontalBlur->setProperty(kDirstep, QVector2D((texelScale / (q->width() * m_dpr)), 0.0));
+    m_verticalBlur->setProperty(kDirstep, QVector2D(0.0, (texelScale / (q->height() * m_dpr))));
+}
+
+void QuickGaussianBlurPrivate::updatePyramid()
+{
+    const bool usePyramid = (m_pyramidEnabled && m_source && (effectiveAlgorithm() == Algorithm::Gaussian)
+                             && !m_computeActive && !m_incrementalBlur);
+    if (usePyramid && (!m_pyramid || (m_pyramid->source() != m_source))) {
+        if (m_pyramid) {
+            disconnect(m_pyramid.get(), nullptr, this, nullptr);
+        }
+        m_pyramid = QGfxBlurPyramid::acquire(m_source);
+        connect(m_pyramid.get(), &QGfxBlurPyramid::levelsChanged, this, &QuickGaussianBlurPrivate::updatePyramidInput);
+        connect(m_pyramid.get(), &QGfxBlurPyramid::levelsChanged, this, &QuickGaussianBlurPrivate::updateGeometry);
+        connect(m_pyramid.get(), &QGfxBlurPyramid::levelsChanged, this, &QuickGaussianBlurPrivate::invalidate);
+    } else if (!usePyramid && m_pyramid) {
+        disconnect(m_pyramid.get(), nullptr, this, nullptr);
+        m_pyramid.reset();
+    }
+    m_pyramidLevel = (m_pyramid ? QGfxBlurPyramid::levelForRadius(m_radius) : 0);
+    // Level 0 is the source item itself. The incremental passes read the source
+    // on their own, the proxy would only render it for nothing.
+    if (m_incrementalBlur) {
+        m_sourceProxy->setInput(nullptr);
+        m_incrementalBlur->setSource(m_source);
+    } else if (m_pyramid) {
+        updatePyramidInput();
+    } else {
+        m_sourceProxy->setInput(m_source);
+    }
+}
+
+void QuickGaussianBlurPrivate::updatePyramidInput()
+{
+    // Also called whenever the pyramid changed its levels, which may be other
+    // items than the ones the proxy was pointed to before.
+    if (!m_pyramid || m_incrementalBlur) {
+        return;
+    }
+    m_sourceProxy->setInput(m_pyramid->level(m_pyramidLevel));
+}
+
+QuickGaussianBlur::Algorithm QuickGaussianBlurPrivate::effectiveAlgorithm() const
+{
+    // Masks and alpha-only blurs are only implemented by the gaussian passes.
+    if (m_alphaOnly || m_maskSource) {
+        return Algorithm::Gaussian;
+    }
+    return m_algorithm;
+}
+
+void QuickGaussianBlurPrivate::rebuildPasses()
+{
+    // Anything the passes are still waiting for is outdated now.
+    const quint64 generation = ++m_shaderGeneration;
+    m_verticalBlur->setVisible(false);
+
+    QFuture<QList<QGfxShaderUrls>> future = {};
+    qsizetype passCount = 0;
+    if (m_algorithm == Algorithm::DualKawase) {
+        // The offset covers whatever the halvings leave of the radius.
+        m_kawaseIterations = 1;
+        while ((m_kawaseIterations < sc_maximumKawaseIterations)
+               && ((m_radius / qreal(1 << (m_kawaseIterations + 1))) > 2.0)) {
+            ++m_kawaseIterations;
+        }
+        m_kawaseOffset = qMax(1.0, (m_radius / qreal(1 << (m_kawaseIterations + 1))));
+        future = QGfxShaderBuilder::staticShadersAsync(u"kawase"_qs, {u"kawase_down"_qs, u"kawase_up"_qs});
+        passCount = (m_kawaseIterations * 2);
+    } else {
+        // Three boxes of width w add up to a variance of 3 * (w * w - 1) / 12.
+        // The boxes are measured in the texels of the intermediate textures.
+        const qreal deviation = (m_deviation * intermediateScale());
+        const qreal boxWidth = qSqrt((4.0 * deviation * deviation) + 1.0);
+        m_boxRadius = qBound(1, qRound((boxWidth - 1.0) / 2.0), sc_maximumBoxRadius);
+        future = QGfxShaderBuilder::staticShadersAsync(u"boxblur"_qs, {u"boxblur"_qs});
+        passCount = 6;
+    }
+    // Nothing is drawn until all the passes have their shaders.
+    if (!future.isFinished()) {
+        setReady(false);
+    }
+
+    Q_Q(QuickGaussianBlur);
+    while (m_passes.size() > passCount) {
+        delete m_passes.takeLast();
+    }
+    while (m_passes.size() < passCount) {
+        const auto pass = new QQuickShaderEffect(q);
+        const auto passAnchors = new QQuickAnchors(pass, pass);
+        passAnchors->setFill(q);
+        QQuickItemLayer * const passLayer = QQuickItemPrivate::get(pass)->layer();
+        passLayer->setSmooth(true);
+        passLayer->setSourceRect({0.0, 0.0, 0.0, 0.0});
+        m_passes.append(pass);
+    }
+    updateIntermediateFormat();
+    for (qsizetype i = 0; i != passCount; ++i) {
+        QQuickShaderEffect * const pass = m_passes.at(i);
+        const bool last = (i == (passCount - 1));
+        // Only the last pass is drawn, all the others just feed the next one.
+        QQuickItemPrivate::get(pass)->layer()->setEnabled(!last);
+        pass->setVisible(last && m_ready);
+        pass->setBlending(last);
+        pass->setProperty(kDither, (last ? 1.0 : 0.0));
+        QQuickItem * const input = ((i == 0) ? m_sourceProxy->output() : m_passes.at(i - 1));
+        pass->setProperty(kSource, QVariant::fromValue(input));
+        if (m_algorithm == Algorithm::DualKawase) {
+            pass->setProperty(kOffset, m_kawaseOffset);
+        } else {
+            pass->setProperty(kBoxRadius, qreal(m_boxRadius));
+        }
+    }
+    setCacheSource(m_passes.constLast());
+    updateGeometry();
+
+    if (future.isFinished()) {
+        applyPassShaders(future.result());
+        return;
+    }
+    const auto watcher = new QFutureWatcher<QList<QGfxShaderUrls>>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, generation](){
+        watcher->deleteLater();
+        if (generation != m_shaderGeneration) {
+            return;
+        }
+        applyPassShaders(watcher->result());
+    });
+    watcher->setFuture(future);
+}
+
+void QuickGaussianBlurPrivate::applyPassShaders(const QList<QGfxShaderUrls> &shaders)
+{
+    Q_ASSERT(!shaders.isEmpty());
+    if (shaders.isEmpty()) {
+        return;
+    }
+    // The first half of the passes uses the first shaders, the second half the
+    // last ones. Both are the same for algorithms with a single kind of pass.
+    const QGfxShaderUrls &firstShaders = shaders.constFirst();
+    const QGfxShaderUrls &secondShaders = shaders.constLast();
+    const qsizetype passCount = m_passes.size();
+    for (qsizetype i = 0; i != passCount; ++i) {
+        QQuickShaderEffect * const pass = m_passes.at(i);
+        const QGfxShaderUrls &passShaders = ((i < (passCount / 2)) ? firstShaders : secondShaders);
+        pass->setFragmentShader(passShaders.fragmentShader);
+        pass->setVertexShader(passShaders.vertexShader);
+    }
+    setReady(firstShaders.isValid() && secondShaders.isValid());
+    invalidate();
+}
+
+void QuickGaussianBlurPrivate::clearPasses()
+{
+    if (m_passes.isEmpty()) {
+        return;
+    }
+    qDeleteAll(m_passes);
+    m_passes.clear();
+    setCacheSource(m_verticalBlur.get());
+    m_verticalBlur->setVisible(m_ready && !m_incrementalBlur);
+}
+
+void QuickGaussianBlurPrivate::setComputeActive(const bool value)
+{
+    if (m_computeActive == value) {
+        return;
+    }
+    m_computeActive = value;
+    // The render node replaces both passes, and the cache along with them.
+    warnIfCacheIgnored();
+    Q_Q(QuickGaussianBlur);
+    q->setFlag(QQuickItem::ItemHasContents, m_computeActive);
+    m_verticalBlur->setVisible(m_ready && !m_computeActive);
+    updateCacheVisibility();
+    q->update();
+}
+
+void QuickGaussianBlurPrivate::warnIfCacheIgnored() const
+{
+    if (m_cached && m_computeActive) {
+        qWarning() << "QuickGaussianBlur: The compute path doesn't support caching, the blur is rendered in every frame.";
+    }
+}
+
+void QuickGaussianBlurPrivate::setIncrementalActive(const bool value)
+{
+    if (bool(m_incrementalBlur) == value) {
+        return;
+    }
+    Q_Q(QuickGaussianBlur);
+    if (value) {
+        m_incrementalBlur.reset(new QGfxIncrementalBlur(q));
+        m_incrementalBlur->setDevicePixelRatio(m_dpr);
+        connect(m_incrementalBlur.get(), &QGfxIncrementalBlur::reblurred, q, &QuickGaussianBlur::contentChanged);
+        connect(m_incrementalBlur.get(), &QGfxIncrementalBlur::reblurredFractionChanged, q, &QuickGaussianBlur::reblurredFractionChanged);
+        m_incrementalBlur->output()->setVisible(m_ready);
+    } else {
+        m_incrementalBlur.reset();
+    }
+    // It keeps its own output, the regular passes and the cache are idle meanwhile.
+    m_verticalBlur->setVisible(m_ready && !m_computeActive && !value);
+    updateCacheVisibility();
+    Q_EMIT q->reblurredFractionChanged();
+}
+
+void QuickGaussianBlurPrivate::updateIncrementalMargin()
+{
+    if (!m_incrementalBlur) {
+        return;
+    }
+    // The radius is measured in device pixels.
+    m_incrementalBlur->setMargin(qCeil(m_radius / m_dpr) + 1.0);
+}
+
+bool QuickGaussianBlurPrivate::isRateLimited() const
+{
+    return ((m_updateInterval > 0) && !m_computeActive && !m_incrementalBlur);
+}
+
+void QuickGaussianBlurPrivate::updateCacheVisibility()
+{
+    const bool rateLimited = isRateLimited();
+    // A rate limited blur shows the cache as well, it's just grabbed on a timer.
+    const bool useCache = ((m_cached || rateLimited) && !m_computeActive && !m_incrementalBlur);
+    const bool crossfade = (rateLimited && m_temporalBlending);
+    if (crossfade && !m_crossfade) {
+        Q_Q(QuickGaussianBlur);
+        m_previousCacheItem.reset(new QQuickShaderEffectSource(q));
+        const auto previousCacheItemAnchors = new QQuickAnchors(m_previousCacheItem.get(), m_previousCacheItem.get());
+        previousCacheItemAnchors->setFill(m_verticalBlur.get());
+        m_previousCacheItem->setSmooth(true);
+        m_previousCacheItem->setSourceItem(m_cacheItem->sourceItem());
+        m_previousCacheItem->setLive(false);
+        m_previousCacheItem->setHideSource(true);
+        m_previousCacheItem->setVisible(false);
+        m_crossfade.reset(new QQuickShaderEffect(q));
+        const auto crossfadeAnchors = new QQuickAnchors(m_crossfade.get(), m_crossfade.get());
+        crossfadeAnchors->setFill(m_verticalBlur.get());
+        const QGfxShaderUrls shaders = QGfxShaderBuilder::staticShaders(u"crossfade"_qs);
+        m_crossfade->setVertexShader(shaders.vertexShader);
+        m_crossfade->setFragmentShader(shaders.fragmentShader);
+        m_crossfade->setProperty(kPreviousSource, QVariant::fromValue(static_cast<QQuickItem *>(m_cacheItem.get())));
+        m_crossfade->setProperty(kNextSource, QVariant::fromValue(static_cast<QQuickItem *>(m_cacheItem.get())));
+        m_crossfade->setProperty(kProgress, 1.0);
+    } else if (!crossfade && m_crossfade) {
+        m_crossfadeAnimation.stop();
+        m_crossfade.reset();
+        m_previousCacheItem.reset();
+    }
+    m_cacheItem->setHideSource(useCache);
+    m_cacheItem->setVisible(useCache && !crossfade);
+    if (!rateLimited) {
+        m_updateTimer.stop();
+        m_updatePending = false;
+    }
+}
+
+void QuickGaussianBlurPrivate::setCacheSource(QQuickItem *item)
+{
+    m_cacheItem->setSourceItem(item);
+    if (m_previousCacheItem) {
+        m_previousCacheItem->setSourceItem(item);
+    }
+}
+
+void QuickGaussianBlurPrivate::grabOutput()
+{
+    m_updatePending = false;
+    if (m_crossfade) {
+        // The older grab is overwritten, the fade starts from the one on screen.
+        m_cacheItem.swap(m_previousCacheItem);
+        m_crossfade->setProperty(kPreviousSource, QVariant::fromValue(static_cast<QQuickItem *>(m_previousCacheItem.get())));
+        m_crossfade->setProperty(kNextSource, QVariant::fromValue(static_cast<QQuickItem *>(m_cacheItem.get())));
+        m_crossfade->setProperty(kProgress, 0.0);
+        m_crossfadeAnimation.stop();
+        m_crossfadeAnimation.setDuration(m_updateInterval);
+        m_crossfadeAnimation.start();
+    }
+    m_cacheItem->scheduleUpdate();
+    Q_Q(QuickGaussianBlur);
+    Q_EMIT q->contentChanged();
+}
+
+void QuickGaussianBlurPrivate::updateRateLimit()
+{
+    m_updateTimer.setInterval(m_updateInterval);
+    updateCacheVisibility();
+    invalidate();
+}
+
+void QuickGaussianBlurPrivate::updateTimeout()
+{
+    // A live source may have changed at any time, a cached one tells us.
+    if (m_cached && !m_updatePending) {
+        m_updateTimer.stop();
+        return;
+    }
+    grabOutput();
+}
+
+bool QuickGaussianBlurPrivate::isWaitingForCapabilities() const
+{
+    Q_Q(const QuickGaussianBlur);
+    const QQuickWindow * const window = q->window();
+    return (window && !window->isSceneGraphInitialized() && !QGfxShaderBuilder::hasResolvedCapabilities());
+}
+
+bool QuickGaussianBlurPrivate::capabilitiesChanged() const
+{
+    return ((QGfxShaderBuilder::maximumBlurSamples() != m_maxBlurSamples)
+            || (m_compute && (QGfxShaderBuilder::isComputeSupported() != m_computeSupported)));
+}
+
+void QuickGaussianBlurPrivate::updateIntermediateFormat()
+{
+    const QQuickShaderEffectSource::Format format = ((m_intermediateFormat == IntermediateFormat::RGBA16F)
+        ? QQuickShaderEffectSource::RGBA16F : QQuickShaderEffectSource::RGBA8);
+    m_sourceProxy->setFormat(format);
+    m_sourceProxy->setTextureScale(intermediateScale());
+    QQuickItemPrivate::get(m_horizontalBlur.get())->layer()->setFormat(format);
+    QQuickItemPrivate::get(m_verticalBlur.get())->layer()->setFormat(format);
+    for (auto &&pass : std::as_const(m_passes)) {
+        QQuickItemPrivate::get(pass)->layer()->setFormat(format);
+    }
+    if (m_incrementalBlur) {
+        QQuickItemPrivate::get(m_incrementalBlur->horizontalPass())->layer()->setFormat(format);
+        QQuickItemPrivate::get(m_incrementalBlur->verticalPass())->layer()->setFormat(format);
+    }
+}
+
+qreal QuickGaussianBlurPrivate::intermediateScale() const
+{
+    switch (m_intermediateResolution) {
+    case IntermediateResolution::Full:
+        break;
+    case IntermediateResolution::Half:
+        return 0.5;
+    case IntermediateResolution::Quarter:
+        return 0.25;
+    }
+    return 1.0;
+}
+
+QSize QuickGaussianBlurPrivate::intermediateTextureSize() const
+{
+    // An empty size makes the layers follow the item's size.
+    if (m_intermediateResolution == IntermediateResolution::Full) {
+        return {};
+    }
+    Q_Q(const QuickGaussianBlur);
+    const qreal scale = (m_dpr * intermediateScale());
+    return QSize(qMax(1, qCeil(q->width() * scale)), qMax(1, qCeil(q->height() * scale)));
+}
+
+QQuickItem *QuickGaussianBlurPrivate::outputItem() const
+{
+    if (m_incrementalBlur) {
+        return m_incrementalBlur->output();
+    }
+    return (m_passes.isEmpty() ? m_verticalBlur.get() : m_passes.constLast());
 }
 
 void QuickGaussianBlurPrivate::updateDpr(const qreal newDpr)
@@ -128,26 +750,90 @@ void QuickGaussianBlurPrivate::updateDpr(const qreal newDpr)
         return;
     }
     m_dpr = newDpr;
-    rebuildShaders();
+    updateGeometry();
+    if (m_incrementalBlur) {
+        m_incrementalBlur->setDevicePixelRatio(m_dpr);
+        updateIncrementalMargin();
+    }
+    invalidate();
+}
+
+void QuickGaussianBlurPrivate::rebindWindow(QQuickWindow *window)
+{
+    if (m_resolveCapabilitiesConnection) {
+        disconnect(m_resolveCapabilitiesConnection);
+        m_resolveCapabilitiesConnection = {};
+    }
+    if (m_sceneGraphInitializedConnection) {
+        disconnect(m_sceneGraphInitializedConnection);
+        m_sceneGraphInitializedConnection = {};
+    }
+    if (!window) {
+        return;
+    }
+    // The backend limits are only known for sure once a scene graph is up, a
+    // better kernel may become available for us at that point.
+    QGfxShaderBuilder::resolveCapabilities(window);
+    updateCapabilities();
+    // The signal is emitted in the render thread, which must not touch the blur
+    // since it may be destroyed at any time by the GUI thread. The limits are
+    // resolved there without it, the blur only hears about them through the
+    // queued connection, which runs after the direct one and is dropped by Qt
+    // if the blur goes away in the meantime.
+    m_resolveCapabilitiesConnection = connect(window, &QQuickWindow::sceneGraphInitialized, window, [window](){
+        QGfxShaderBuilder::resolveCapabilities(window);
+    }, Qt::DirectConnection);
+    m_sceneGraphInitializedConnection = connect(window, &QQuickWindow::sceneGraphInitialized,
+                                                this, &QuickGaussianBlurPrivate::updateCapabilities, Qt::QueuedConnection);
+}
+
+void QuickGaussianBlurPrivate::updateCapabilities()
+{
+    if (m_capabilitiesPending || capabilitiesChanged()) {
+        scheduleRebuild();
+    }
 }
 
 void QuickGaussianBlurPrivate::initialize()
 {
     Q_Q(QuickGaussianBlur);
-    connect(q, &QuickGaussianBlur::widthChanged, this, &QuickGaussianBlurPrivate::rebuildShaders);
-    connect(q, &QuickGaussianBlur::heightChanged, this, &QuickGaussianBlurPrivate::rebuildShaders);
-    connect(q, &QuickGaussianBlur::radiusChanged, this, &QuickGaussianBlurPrivate::rebuildShaders);
-    connect(q, &QuickGaussianBlur::samplesChanged, this, &QuickGaussianBlurPrivate::rebuildShaders);
-    connect(q, &QuickGaussianBlur::deviationChanged, this, &QuickGaussianBlurPrivate::rebuildShaders);
+    connect(q, &QuickGaussianBlur::widthChanged, this, &QuickGaussianBlurPrivate::updateGeometry);
+    connect(q, &QuickGaussianBlur::heightChanged, this, &QuickGaussianBlurPrivate::updateGeometry);
+    connect(q, &QuickGaussianBlur::widthChanged, this, &QuickGaussianBlurPrivate::invalidate);
+    connect(q, &QuickGaussianBlur::heightChanged, this, &QuickGaussianBlurPrivate::invalidate);
+    connect(q, &QuickGaussianBlur::sourceChanged, this, &QuickGaussianBlurPrivate::scheduleRebuild);
+    connect(q, &QuickGaussianBlur::radiusChanged, this, &QuickGaussianBlurPrivate::scheduleRebuild);
+    connect(q, &QuickGaussianBlur::samplesChanged, this, &QuickGaussianBlurPrivate::scheduleRebuild);
+    connect(q, &QuickGaussianBlur::deviationChanged, this, &QuickGaussianBlurPrivate::scheduleRebuild);
+    connect(q, &QuickGaussianBlur::kernelModeChanged, this, &QuickGaussianBlurPrivate::scheduleRebuild);
+    connect(q, &QuickGaussianBlur::pyramidChanged, this, &QuickGaussianBlurPrivate::scheduleRebuild);
+    connect(q, &QuickGaussianBlur::algorithmChanged, this, &QuickGaussianBlurPrivate::scheduleRebuild);
+    connect(q, &QuickGaussianBlur::computeChanged, this, &QuickGaussianBlurPrivate::scheduleRebuild);
+    connect(q, &QuickGaussianBlur::intermediateResolutionChanged, this, &QuickGaussianBlurPrivate::scheduleRebuild);
+    connect(q, &QuickGaussianBlur::intermediateFormatChanged, this, &QuickGaussianBlurPrivate::scheduleRebuild);
+    connect(q, &QuickGaussianBlur::opaqueChanged, this, &QuickGaussianBlurPrivate::scheduleRebuild);
+    connect(q, &QuickGaussianBlur::incrementalChanged, this, &QuickGaussianBlurPrivate::scheduleRebuild);
+    connect(q, &QuickGaussianBlur::updateIntervalChanged, this, &QuickGaussianBlurPrivate::updateRateLimit);
+    connect(q, &QuickGaussianBlur::temporalBlendingChanged, this, &QuickGaussianBlurPrivate::updateRateLimit);
 
-    const QRectF sourceRect = {0.0, 0.0, 0.0, 0.0};
+    connect(&m_updateTimer, &QTimer::timeout, this, &QuickGaussianBlurPrivate::updateTimeout);
+    m_crossfadeAnimation.setStartValue(0.0);
+    m_crossfadeAnimation.setEndValue(1.0);
+    connect(&m_crossfadeAnimation, &QVariantAnimation::valueChanged, this, [this](const QVariant &value){
+        if (!m_crossfade) {
+            return;
+        }
+        m_crossfade->setProperty(kProgress, value);
+        Q_Q(QuickGaussianBlur);
+        Q_EMIT q->contentChanged();
+    });
 
-    m_shaderBuilder.reset(new QGfxShaderBuilder(q));
+    const QRectF sourceRect = {0.0, 0.0, 0.0, 0.0};
 
     m_sourceProxy.reset(new QGfxSourceProxy(q));
     m_sourceProxy->setInterpolation(QGfxSourceProxy::Interpolation::Linear);
     m_sourceProxy->setSourceRect(sourceRect);
-    connect(m_sourceProxy.get(), &QGfxSourceProxy::outputChanged, this, &QuickGaussianBlurPrivate::rebuildShaders);
+    connect(m_sourceProxy.get(), &QGfxSourceProxy::outputChanged, this, &QuickGaussianBlurPrivate::scheduleRebuild);
 
     m_horizontalBlur.reset(new QQuickShaderEffect(q));
     const auto horizontalBlurAnchors = new QQuickAnchors(m_horizontalBlur.get(), m_horizontalBlur.get());
@@ -162,22 +848,26 @@ void QuickGaussianBlurPrivate::initialize()
     m_verticalBlur.reset(new QQuickShaderEffect(q));
     const auto verticalBlurAnchors = new QQuickAnchors(m_verticalBlur.get(), m_verticalBlur.get());
     verticalBlurAnchors->setFill(q);
-    m_verticalBlur->setVisible(true);
+    m_verticalBlur->setVisible(false);
 
     m_cacheItem.reset(new QQuickShaderEffectSource(q));
     const auto cacheItemAnchors = new QQuickAnchors(m_cacheItem.get(), m_cacheItem.get());
     cacheItemAnchors->setFill(m_verticalBlur.get());
     m_cacheItem->setSmooth(true);
     m_cacheItem->setSourceItem(m_verticalBlur.get());
-    m_cacheItem->setLive(true);
+    m_cacheItem->setLive(false);
     m_cacheItem->setHideSource(m_cached);
     m_cacheItem->setVisible(m_cached);
 
-    rebuildShaders();
+    scheduleRebuild();
 }
 
 QuickGaussianBlur::QuickGaussianBlur(QQuickItem *parent) : QQuickItem(parent), d_ptr(new QuickGaussianBlurPrivate(this))
 {
+    qRegisterMetaType<KernelMode>();
+    qRegisterMetaType<Algorithm>();
+    qRegisterMetaType<IntermediateResolution>();
+    qRegisterMetaType<IntermediateFormat>();
 }
 
 QuickGaussianBlur::~QuickGaussianBlur() = default;
@@ -199,8 +889,14 @@ void QuickGaussianBlur::setSource(QQuickItem *item)
         return;
     }
     d->m_source = item;
-    d->m_sourceProxy->setInput(d->m_source);
+    // The proxy is pointed at the source or at one of its pyramid levels by the
+    // next rebuild.
+    QObject::disconnect(d->m_sourceOpaqueConnection);
+    d->m_sourceOpaqueConnection = QGfxSourceProxy::connectOpaqueChanged(d->m_source, this, "opaqueChanged()");
+    QObject::disconnect(d->m_sourceContentConnection);
+    d->m_sourceContentConnection = QGfxSourceProxy::connectContentChanged(d->m_source, d, "invalidate()");
     Q_EMIT sourceChanged();
+    Q_EMIT opaqueChanged();
 }
 
 qreal QuickGaussianBlur::radius() const
@@ -264,16 +960,221 @@ void QuickGaussianBlur::setCached(const bool value)
         return;
     }
     d->m_cached = value;
-    d->m_cacheItem->setHideSource(d->m_cached);
-    d->m_cacheItem->setVisible(d->m_cached);
+    d->warnIfCacheIgnored();
+    d->updateCacheVisibility();
+    if (d->m_cached) {
+        d->m_cacheItem->scheduleUpdate();
+    }
     Q_EMIT cachedChanged();
 }
 
+bool QuickGaussianBlur::isReady() const
+{
+    Q_D(const QuickGaussianBlur);
+    return d->m_ready;
+}
+
+QuickGaussianBlur::KernelMode QuickGaussianBlur::kernelMode() const
+{
+    Q_D(const QuickGaussianBlur);
+    return d->m_kernelMode;
+}
+
+void QuickGaussianBlur::setKernelMode(const KernelMode value)
+{
+    Q_D(QuickGaussianBlur);
+    if (d->m_kernelMode == value) {
+        return;
+    }
+    d->m_kernelMode = value;
+    Q_EMIT kernelModeChanged();
+}
+
+bool QuickGaussianBlur::isPyramid() const
+{
+    Q_D(const QuickGaussianBlur);
+    return d->m_pyramidEnabled;
+}
+
+void QuickGaussianBlur::setPyramid(const bool value)
+{
+    Q_D(QuickGaussianBlur);
+    if (d->m_pyramidEnabled == value) {
+        return;
+    }
+    d->m_pyramidEnabled = value;
+    Q_EMIT pyramidChanged();
+}
+
+QuickGaussianBlur::Algorithm QuickGaussianBlur::algorithm() const
+{
+    Q_D(const QuickGaussianBlur);
+    return d->m_algorithm;
+}
+
+void QuickGaussianBlur::setAlgorithm(const Algorithm value)
+{
+    Q_D(QuickGaussianBlur);
+    if (d->m_algorithm == value) {
+        return;
+    }
+    d->m_algorithm = value;
+    Q_EMIT algorithmChanged();
+}
+
+bool QuickGaussianBlur::isCompute() const
+{
+    Q_D(const QuickGaussianBlur);
+    return d->m_compute;
+}
+
+void QuickGaussianBlur::setCompute(const bool value)
+{
+    Q_D(QuickGaussianBlur);
+    if (d->m_compute == value) {
+        return;
+    }
+    d->m_compute = value;
+    Q_EMIT computeChanged();
+}
+
+QuickGaussianBlur::IntermediateResolution QuickGaussianBlur::intermediateResolution() const
+{
+    Q_D(const QuickGaussianBlur);
+    return d->m_intermediateResolution;
+}
+
+void QuickGaussianBlur::setIntermediateResolution(const IntermediateResolution value)
+{
+    Q_D(QuickGaussianBlur);
+    if (d->m_intermediateResolution == value) {
+        return;
+    }
+    d->m_intermediateResolution = value;
+    Q_EMIT intermediateResolutionChanged();
+}
+
+QuickGaussianBlur::IntermediateFormat QuickGaussianBlur::intermediateFormat() const
+{
+    Q_D(const QuickGaussianBlur);
+    return d->m_intermediateFormat;
+}
+
+void QuickGaussianBlur::setIntermediateFormat(const IntermediateFormat value)
+{
+    Q_D(QuickGaussianBlur);
+    if (d->m_intermediateFormat == value) {
+        return;
+    }
+    d->m_intermediateFormat = value;
+    Q_EMIT intermediateFormatChanged();
+}
+
+bool QuickGaussianBlur::isOpaque() const
+{
+    Q_D(const QuickGaussianBlur);
+    return QGfxSourceProxy::isOpaque(d->m_source);
+}
+
+bool QuickGaussianBlur::isIncremental() const
+{
+    Q_D(const QuickGaussianBlur);
+    return d->m_incremental;
+}
+
+void QuickGaussianBlur::setIncremental(const bool value)
+{
+    Q_D(QuickGaussianBlur);
+    if (d->m_incremental == value) {
+        return;
+    }
+    d->m_incremental = value;
+    Q_EMIT incrementalChanged();
+}
+
+qreal QuickGaussianBlur::reblurredFraction() const
+{
+    Q_D(const QuickGaussianBlur);
+    return (d->m_incrementalBlur ? d->m_incrementalBlur->reblurredFraction() : 1.0);
+}
+
+int QuickGaussianBlur::updateInterval() const
+{
+    Q_D(const QuickGaussianBlur);
+    return d->m_updateInterval;
+}
+
+void QuickGaussianBlur::setUpdateInterval(const int value)
+{
+    Q_D(QuickGaussianBlur);
+    const int interval = qMax(0, value);
+    if (d->m_updateInterval == interval) {
+        return;
+    }
+    d->m_updateInterval = interval;
+    Q_EMIT updateIntervalChanged();
+}
+
+bool QuickGaussianBlur::isTemporalBlending() const
+{
+    Q_D(const QuickGaussianBlur);
+    return d->m_temporalBlending;
+}
+
+void QuickGaussianBlur::setTemporalBlending(const bool value)
+{
+    Q_D(QuickGaussianBlur);
+    if (d->m_temporalBlending == value) {
+        return;
+    }
+    d->m_temporalBlending = value;
+    Q_EMIT temporalBlendingChanged();
+}
+
+void QuickGaussianBlur::markDirty()
+{
+    Q_D(QuickGaussianBlur);
+    d->invalidate();
+}
+
+void QuickGaussianBlur::updatePolish()
+{
+    QQuickItem::updatePolish();
+    Q_D(QuickGaussianBlur);
+    if (d->m_rebuildScheduled) {
+        d->rebuildShaders();
+    }
+}
+
+QSGNode *QuickGaussianBlur::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data)
+{
+#if (QT_VERSION >= QT_VERSION_CHECK(6, 6, 0))
+    Q_UNUSED(data);
+    Q_D(QuickGaussianBlur);
+    QQuickItem * const input = d->m_sourceProxy->output();
+    if (!d->m_computeActive || !input || !input->isTextureProvider()) {
+        delete oldNode;
+        return nullptr;
+    }
+    auto node = static_cast<QGfxComputeBlurNode *>(oldNode);
+    if (!node) {
+        node = new QGfxComputeBlurNode(window());
+    }
+    node->sync(input->textureProvider(), size(), window()->effectiveDevicePixelRatio(), qRound(d->m_radius), d->m_deviation);
+    return node;
+#else
+    return QQuickItem::updatePaintNode(oldNode, data);
+#endif
+}
+
 void QuickGaussianBlur::itemChange(const ItemChange change, const ItemChangeData &value)
 {
     QQuickItem::itemChange(change, value);
     if (change == ItemDevicePixelRatioHasChanged) {
         Q_D(QuickGaussianBlur);
         d->updateDpr(value.realValue);
+    } else if (change == ItemSceneChange) {
+        Q_D(QuickGaussianBlur);
+        d->rebindWindow(value.window);
     }
 }
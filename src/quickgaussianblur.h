@@ -42,8 +42,51 @@ class QTACRYLICMATERIAL_API QuickGaussianBlur : public QQuickItem
     Q_PROPERTY(int samples READ samples WRITE setSamples NOTIFY samplesChanged FINAL)
     Q_PROPERTY(qreal deviation READ deviation WRITE setDeviation NOTIFY deviationChanged FINAL)
     Q_PROPERTY(bool cached READ isCached WRITE setCached NOTIFY cachedChanged FINAL)
+    Q_PROPERTY(bool ready READ isReady NOTIFY readyChanged FINAL)
+    Q_PROPERTY(KernelMode kernelMode READ kernelMode WRITE setKernelMode NOTIFY kernelModeChanged FINAL)
+    Q_PROPERTY(bool pyramid READ isPyramid WRITE setPyramid NOTIFY pyramidChanged FINAL)
+    Q_PROPERTY(Algorithm algorithm READ algorithm WRITE setAlgorithm NOTIFY algorithmChanged FINAL)
+    Q_PROPERTY(bool compute READ isCompute WRITE setCompute NOTIFY computeChanged FINAL)
+    Q_PROPERTY(IntermediateResolution intermediateResolution READ intermediateResolution WRITE setIntermediateResolution NOTIFY intermediateResolutionChanged FINAL)
+    Q_PROPERTY(IntermediateFormat intermediateFormat READ intermediateFormat WRITE setIntermediateFormat NOTIFY intermediateFormatChanged FINAL)
+    Q_PROPERTY(bool opaque READ isOpaque NOTIFY opaqueChanged FINAL)
+    Q_PROPERTY(bool incremental READ isIncremental WRITE setIncremental NOTIFY incrementalChanged FINAL)
+    Q_PROPERTY(qreal reblurredFraction READ reblurredFraction NOTIFY reblurredFractionChanged FINAL)
+    Q_PROPERTY(int updateInterval READ updateInterval WRITE setUpdateInterval NOTIFY updateIntervalChanged FINAL)
+    Q_PROPERTY(bool temporalBlending READ isTemporalBlending WRITE setTemporalBlending NOTIFY temporalBlendingChanged FINAL)
 
 public:
+    enum class KernelMode
+    {
+        Static, // The kernel is compiled into the shaders, fastest to render.
+        Dynamic // The kernel is fed through uniforms, radius and deviation can animate freely.
+    };
+    Q_ENUM(KernelMode)
+
+    enum class Algorithm
+    {
+        Gaussian, // Separable gaussian, the reference look.
+        DualKawase, // Down- and upsampling chain, the cheapest one for big radii.
+        Box // Three box blurs in each direction, approximates the gaussian.
+    };
+    Q_ENUM(Algorithm)
+
+    // Only applies to the textures between the passes. The final pass renders in
+    // full resolution and is dithered, except for pyramid levels above zero: it
+    // then renders in the resolution of the level and its layer scales it up,
+    // so it isn't dithered, the pattern would be scaled up along with it.
+    enum class IntermediateResolution
+    {
+        Full, Half, Quarter
+    };
+    Q_ENUM(IntermediateResolution)
+
+    enum class IntermediateFormat
+    {
+        RGBA8, RGBA16F
+    };
+    Q_ENUM(IntermediateFormat)
+
     explicit QuickGaussianBlur(QQuickItem *parent = nullptr);
     ~QuickGaussianBlur() override;
 
@@ -59,10 +102,72 @@ public:
     [[nodiscard]] qreal deviation() const;
     void setDeviation(const qreal value);
 
+    // A cached blur is rendered once and then only when its parameters, its size or
+    // its source change. Sources which can't tell about new content through a
+    // contentChanged() signal need markDirty() to be called. Not honored while the
+    // compute path is active, which blurs in every frame, a warning says so.
     [[nodiscard]] bool isCached() const;
     void setCached(const bool value);
 
+    [[nodiscard]] bool isReady() const;
+
+    [[nodiscard]] KernelMode kernelMode() const;
+    void setKernelMode(const KernelMode value);
+
+    [[nodiscard]] bool isPyramid() const;
+    void setPyramid(const bool value);
+
+    // DualKawase and Box don't implement masks and alpha-only blurs (including
+    // their color and thickness), such blurs always use the gaussian passes.
+    // All the algorithms can be cached.
+    [[nodiscard]] Algorithm algorithm() const;
+    void setAlgorithm(const Algorithm value);
+
+    // Only honored by the gaussian algorithm, and only if the backend supports
+    // compute shaders. Falls back to the regular passes otherwise. The compute
+    // path can't be cached, see cached.
+    [[nodiscard]] bool isCompute() const;
+    void setCompute(const bool value);
+
+    [[nodiscard]] IntermediateResolution intermediateResolution() const;
+    void setIntermediateResolution(const IntermediateResolution value);
+
+    [[nodiscard]] IntermediateFormat intermediateFormat() const;
+    void setIntermediateFormat(const IntermediateFormat value);
+
+    // The blur of an opaque source is opaque as well.
+    [[nodiscard]] bool isOpaque() const;
+
+    // Only the parts of the output which are affected by a change of the source
+    // are blurred again, the rest is kept from the previous frames. Meant for
+    // live sources where little changes at a time. Only honored by the gaussian
+    // algorithm in full intermediate resolution, without mask, and it takes
+    // precedence over the pyramid.
+    [[nodiscard]] bool isIncremental() const;
+    void setIncremental(const bool value);
+
+    // The part of the output blurred again in the last frame, for diagnostics.
+    // Always 1 unless the blur is incremental.
+    [[nodiscard]] qreal reblurredFraction() const;
+
+    // The minimum time between two blurs, in milliseconds. The last result is
+    // shown in between, so the cost of a live source no longer depends on the
+    // frame rate. 0 blurs in every frame. Not honored by the compute and the
+    // incremental blurs.
+    [[nodiscard]] int updateInterval() const;
+    void setUpdateInterval(const int value);
+
+    // Fades from the previous result to the new one over the update interval
+    // instead of switching at once, which hides the steps of moving content at
+    // the price of some more latency.
+    [[nodiscard]] bool isTemporalBlending() const;
+    void setTemporalBlending(const bool value);
+
+    Q_INVOKABLE void markDirty();
+
 protected:
+    void updatePolish() override;
+    [[nodiscard]] QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
     void itemChange(const ItemChange change, const ItemChangeData &value) override;
 
 Q_SIGNALS:
@@ -71,6 +176,19 @@ Q_SIGNALS:
     void samplesChanged();
     void deviationChanged();
     void cachedChanged();
+    void readyChanged();
+    void kernelModeChanged();
+    void pyramidChanged();
+    void algorithmChanged();
+    void computeChanged();
+    void intermediateResolutionChanged();
+    void intermediateFormatChanged();
+    void opaqueChanged();
+    void contentChanged();
+    void incrementalChanged();
+    void reblurredFractionChanged();
+    void updateIntervalChanged();
+    void temporalBlendingChanged();
 
 private:
     QScopedPointer<QuickGaussianBlurPrivate> d_ptr;
@@ -25,18 +25,24 @@
 #pragma once
 
 #include "qtacrylicmaterial_global.h"
+#include "quickgaussianblur.h"
 #include <QtCore/qobject.h>
+#include <QtCore/qsharedpointer.h>
+#include <QtCore/qtimer.h>
+#include <QtCore/qvariantanimation.h>
 
 QT_BEGIN_NAMESPACE
 class QScreen;
+class QQuickWindow;
 class QQuickItem;
 class QQuickShaderEffect;
 class QQuickShaderEffectSource;
+struct QGfxShaderUrls;
 QT_END_NAMESPACE
 
-class QuickGaussianBlur;
-class QGfxShaderBuilder;
 class QGfxSourceProxy;
+class QGfxBlurPyramid;
+class QGfxIncrementalBlur;
 
 class QTACRYLICMATERIAL_API QuickGaussianBlurPrivate : public QObject
 {
@@ -45,6 +51,11 @@ class QTACRYLICMATERIAL_API QuickGaussianBlurPrivate : public QObject
     Q_DISABLE_COPY_MOVE(QuickGaussianBlurPrivate)
 
 public:
+    using KernelMode = QuickGaussianBlur::KernelMode;
+    using Algorithm = QuickGaussianBlur::Algorithm;
+    using IntermediateResolution = QuickGaussianBlur::IntermediateResolution;
+    using IntermediateFormat = QuickGaussianBlur::IntermediateFormat;
+
     explicit QuickGaussianBlurPrivate(QuickGaussianBlur *q);
     ~QuickGaussianBlurPrivate() override;
 
@@ -52,13 +63,43 @@ public:
     [[nodiscard]] static const QuickGaussianBlurPrivate *get(const QuickGaussianBlur *pub);
 
 public Q_SLOTS:
+    void scheduleRebuild();
     void rebuildShaders();
+    void invalidate();
 
 private Q_SLOTS:
+    void updateGeometry();
     void updateDpr(const qreal newDpr);
+    void updateRateLimit();
+    void updateTimeout();
+    void updateCapabilities();
+    void updatePyramidInput();
 
 private:
     void initialize();
+    void applyUniforms();
+    void applyShaders(const QGfxShaderUrls &shaders);
+    void rebindWindow(QQuickWindow *window);
+    void setReady(const bool value);
+    void updatePyramid();
+    [[nodiscard]] Algorithm effectiveAlgorithm() const;
+    void rebuildPasses();
+    void applyPassShaders(const QList<QGfxShaderUrls> &shaders);
+    void clearPasses();
+    [[nodiscard]] QQuickItem *outputItem() const;
+    void setComputeActive(const bool value);
+    void warnIfCacheIgnored() const;
+    void setIncrementalActive(const bool value);
+    void updateIncrementalMargin();
+    [[nodiscard]] bool isRateLimited() const;
+    void updateCacheVisibility();
+    void setCacheSource(QQuickItem *item);
+    void grabOutput();
+    void updateIntermediateFormat();
+    [[nodiscard]] qreal intermediateScale() const;
+    [[nodiscard]] QSize intermediateTextureSize() const;
+    [[nodiscard]] bool capabilitiesChanged() const;
+    [[nodiscard]] bool isWaitingForCapabilities() const;
 
 private:
     QuickGaussianBlur *q_ptr = nullptr;
@@ -73,9 +114,51 @@ private:
     qreal m_thickness = 0.0;
     qreal m_dpr = 1.0;
     QQuickItem *m_maskSource = nullptr;
-    QScopedPointer<QGfxShaderBuilder> m_shaderBuilder;
+    bool m_ready = false;
+    quint64 m_shaderGeneration = 0;
+    int m_maxBlurSamples = 0;
+    KernelMode m_kernelMode = KernelMode::Static;
+    bool m_dynamicKernel = false;
+    bool m_rebuildScheduled = false;
+    bool m_pyramidEnabled = false;
+    int m_pyramidLevel = 0;
+    // The radius and the deviation in the pixels of the level which is blurred.
+    qreal m_effectiveRadius = 0.0;
+    qreal m_effectiveDeviation = 0.0;
+    QSharedPointer<QGfxBlurPyramid> m_pyramid;
+    Algorithm m_algorithm = Algorithm::Gaussian;
+    int m_kawaseIterations = 0;
+    qreal m_kawaseOffset = 0.0;
+    int m_boxRadius = 0;
+    // The render passes of all the algorithms except the gaussian one, the last
+    // pass is the one which is visible.
+    QList<QQuickShaderEffect *> m_passes = {};
+    bool m_compute = false;
+    bool m_computeActive = false;
+    bool m_computeSupported = false;
+    IntermediateResolution m_intermediateResolution = IntermediateResolution::Full;
+    IntermediateFormat m_intermediateFormat = IntermediateFormat::RGBA8;
+    bool m_incremental = false;
+    // Only exists while the blur is incremental.
+    QScopedPointer<QGfxIncrementalBlur> m_incrementalBlur;
+    int m_updateInterval = 0;
+    bool m_temporalBlending = false;
+    // Something changed since the last grab of a rate limited blur.
+    bool m_updatePending = false;
+    QTimer m_updateTimer;
+    QVariantAnimation m_crossfadeAnimation;
+    QMetaObject::Connection m_resolveCapabilitiesConnection = {};
+    QMetaObject::Connection m_sceneGraphInitializedConnection = {};
+    // A rebuild was put off until the scene graph reports the real limits.
+    bool m_capabilitiesPending = false;
+    QMetaObject::Connection m_sourceOpaqueConnection = {};
+    QMetaObject::Connection m_sourceContentConnection = {};
     QScopedPointer<QGfxSourceProxy> m_sourceProxy;
     QScopedPointer<QQuickShaderEffect> m_horizontalBlur;
     QScopedPointer<QQuickShaderEffect> m_verticalBlur;
     QScopedPointer<QQuickShaderEffectSource> m_cacheItem;
+    // Only exist while a rate limited blur is blended temporally. The two caches
+    // take turns, m_cacheItem always holds the most recent grab.
+    QScopedPointer<QQuickShaderEffectSource> m_previousCacheItem;
+    QScopedPointer<QQuickShaderEffect> m_crossfade;
 };
@@ -0,0 +1,237 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2022 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#version 440
+
+// QGFX_BLEND_MODE follows the values of QuickBlend::Mode.
+#ifndef QGFX_BLEND_MODE
+#  define QGFX_BLEND_MODE 0
+#endif
+
+// Inputs known to be opaque don't need to be un-premultiplied, and an opaque
+// background always gives an opaque result.
+#ifndef QGFX_OPAQUE_BACKGROUND
+#  define QGFX_OPAQUE_BACKGROUND 0
+#endif
+#ifndef QGFX_OPAQUE_FOREGROUND
+#  define QGFX_OPAQUE_FOREGROUND 0
+#endif
+
+// A foreground of a single color comes in as a uniform, along with its HSL
+// representation which QuickBlend computes the same way as RGBtoHSL() does.
+#ifndef QGFX_SOLID_FOREGROUND
+#  define QGFX_SOLID_FOREGROUND 0
+#endif
+
+layout(location = 0) in vec2 qt_TexCoord0;
+layout(location = 0) out vec4 fragColor;
+
+layout(std140, binding = 0) uniform buf {
+    mat4 qt_Matrix;
+    float qt_Opacity;
+#if QGFX_SOLID_FOREGROUND
+    vec4 foregroundColor;
+    vec3 foregroundHSL;
+#endif
+};
+layout(binding = 1) uniform sampler2D source;
+#if !QGFX_SOLID_FOREGROUND
+layout(binding = 2) uniform sampler2D foregroundSource;
+#endif
+
+// The parts between the markers are shared with the shaders generated by
+// QuickBlendStack, which puts the blend function in once for every mode it
+// uses. Keep them free of anything else from this file.
+// QGFX_BLEND_HELPERS_BEGIN
+#if QGFX_SOLID_FOREGROUND
+#  define QGFX_FOREGROUND_HSL foregroundHSL
+#  define QGFX_FOREGROUND_L foregroundHSL.z
+#else
+#  define QGFX_FOREGROUND_HSL RGBtoHSL(rgb2)
+#  define QGFX_FOREGROUND_L RGBtoL(rgb2)
+#endif
+
+float RGBtoL(vec3 color) {
+    float cmin = min(color.r, min(color.g, color.b));
+    float cmax = max(color.r, max(color.g, color.b));
+    float l = (cmin + cmax) / 2.0;
+    return l;
+}
+
+vec3 RGBtoHSL(vec3 color) {
+    float cmin = min(color.r, min(color.g, color.b));
+    float cmax = max(color.r, max(color.g, color.b));
+    float h = 0.0;
+    float s = 0.0;
+    float l = (cmin + cmax) / 2.0;
+    float diff = cmax - cmin;
+
+    if (diff > 1.0 / 256.0) {
+        if (l < 0.5)
+            s = diff / (cmin + cmax);
+        else
+            s = diff / (2.0 - (cmin + cmax));
+
+        if (color.r == cmax)
+            h = (color.g - color.b) / diff;
+        else if (color.g == cmax)
+            h = 2.0 + (color.b - color.r) / diff;
+        else
+            h = 4.0 + (color.r - color.g) / diff;
+
+        h /= 6.0;
+    }
+    return vec3(h, s, l);
+}
+
+float hueToIntensity(float v1, float v2, float h) {
+    h = fract(h);
+    if (h < 1.0 / 6.0)
+        return v1 + (v2 - v1) * 6.0 * h;
+    else if (h < 1.0 / 2.0)
+        return v2;
+    else if (h < 2.0 / 3.0)
+        return v1 + (v2 - v1) * 6.0 * (2.0 / 3.0 - h);
+
+    return v1;
+}
+
+vec3 HSLtoRGB(vec3 color) {
+    float h = color.x;
+    float l = color.z;
+    float s = color.y;
+
+    if (s < 1.0 / 256.0)
+        return vec3(l, l, l);
+
+    float v1;
+    float v2;
+    if (l < 0.5)
+        v2 = l * (1.0 + s);
+    else
+        v2 = (l + s) - (s * l);
+
+    v1 = 2.0 * l - v2;
+
+    float d = 1.0 / 3.0;
+    float r = hueToIntensity(v1, v2, h + d);
+    float g = hueToIntensity(v1, v2, h);
+    float b = hueToIntensity(v1, v2, h - d);
+    return vec3(r, g, b);
+}
+
+float channelBlendHardLight(float c1, float c2) {
+    return c2 > 0.5 ? (1.0 - (1.0 - 2.0 * (c2 - 0.5)) * (1.0 - c1)) : (2.0 * c1 * c2);
+}
+
+// QGFX_BLEND_HELPERS_END
+
+// QGFX_BLEND_FUNCTION_BEGIN
+// Both colors are un-premultiplied.
+vec3 qgfx_blend(vec3 rgb1, vec3 rgb2) {
+#if QGFX_BLEND_MODE == 1 // Addition
+    return min(rgb1 + rgb2, 1.0);
+#elif QGFX_BLEND_MODE == 2 // Average
+    return 0.5 * (rgb1 + rgb2);
+#elif QGFX_BLEND_MODE == 3 // Color
+    return HSLtoRGB(vec3(QGFX_FOREGROUND_HSL.xy, RGBtoL(rgb1)));
+#elif QGFX_BLEND_MODE == 4 // ColorBurn
+    return clamp(1.0 - ((1.0 - rgb1) / max(vec3(1.0 / 256.0), rgb2)), vec3(0.0), vec3(1.0));
+#elif QGFX_BLEND_MODE == 5 // ColorDodge
+    return clamp(rgb1 / max(vec3(1.0 / 256.0), (1.0 - rgb2)), vec3(0.0), vec3(1.0));
+#elif QGFX_BLEND_MODE == 6 // Darken
+    return min(rgb1, rgb2);
+#elif QGFX_BLEND_MODE == 7 // DarkerColor
+    return 0.3 * rgb1.r + 0.59 * rgb1.g + 0.11 * rgb1.b > 0.3 * rgb2.r + 0.59 * rgb2.g + 0.11 * rgb2.b ? rgb2 : rgb1;
+#elif QGFX_BLEND_MODE == 8 // Difference
+    return abs(rgb1 - rgb2);
+#elif QGFX_BLEND_MODE == 9 // Divide
+    return clamp(rgb1 / rgb2, 0.0, 1.0);
+#elif QGFX_BLEND_MODE == 10 // Exclusion
+    return rgb1 + rgb2 - 2.0 * rgb1 * rgb2;
+#elif QGFX_BLEND_MODE == 11 // HardLight
+    return vec3(channelBlendHardLight(rgb1.r, rgb2.r), channelBlendHardLight(rgb1.g, rgb2.g), channelBlendHardLight(rgb1.b, rgb2.b));
+#elif QGFX_BLEND_MODE == 12 // Hue
+    return HSLtoRGB(vec3(QGFX_FOREGROUND_HSL.x, RGBtoHSL(rgb1).yz));
+#elif QGFX_BLEND_MODE == 13 // Lighten
+    return max(rgb1, rgb2);
+#elif QGFX_BLEND_MODE == 14 // LighterColor
+    return 0.3 * rgb1.r + 0.59 * rgb1.g + 0.11 * rgb1.b > 0.3 * rgb2.r + 0.59 * rgb2.g + 0.11 * rgb2.b ? rgb1 : rgb2;
+#elif QGFX_BLEND_MODE == 15 // Lightness
+    return HSLtoRGB(vec3(RGBtoHSL(rgb1).xy, QGFX_FOREGROUND_L));
+#elif QGFX_BLEND_MODE == 16 // Multiply
+    return rgb1 * rgb2;
+#elif QGFX_BLEND_MODE == 17 // Negation
+    return 1.0 - abs(1.0 - rgb1 - rgb2);
+#elif QGFX_BLEND_MODE == 18 // Saturation
+    vec3 hsl1 = RGBtoHSL(rgb1);
+    return HSLtoRGB(vec3(hsl1.x, QGFX_FOREGROUND_HSL.y, hsl1.z));
+#elif QGFX_BLEND_MODE == 19 // Screen
+    return 1.0 - (vec3(1.0) - rgb1) * (vec3(1.0) - rgb2);
+#elif QGFX_BLEND_MODE == 20 // Subtract
+    return max(rgb1 - rgb2, vec3(0.0));
+#elif QGFX_BLEND_MODE == 21 // SoftLight
+    return rgb1 * ((1.0 - rgb1) * rgb2 + (1.0 - (1.0 - rgb1) * (1.0 - rgb2)));
+#else // Normal
+    return rgb2;
+#endif
+}
+// QGFX_BLEND_FUNCTION_END
+
+void main() {
+    vec4 color1 = texture(source, qt_TexCoord0);
+#if QGFX_SOLID_FOREGROUND
+    vec4 color2 = foregroundColor;
+#else
+    vec4 color2 = texture(foregroundSource, qt_TexCoord0);
+#endif
+#if QGFX_OPAQUE_BACKGROUND
+    vec3 rgb1 = color1.rgb;
+#else
+    vec3 rgb1 = color1.rgb / max(1.0/256.0, color1.a);
+#  if QGFX_BLEND_MODE == 0
+    float a = max(color1.a, color2.a);
+#  else
+    float a = max(color1.a, color1.a * color2.a);
+#  endif
+#endif
+#if QGFX_OPAQUE_FOREGROUND
+    vec3 rgb2 = color2.rgb;
+#else
+    vec3 rgb2 = color2.rgb / max(1.0/256.0, color2.a);
+#endif
+
+#if QGFX_OPAQUE_FOREGROUND
+    fragColor.rgb = qgfx_blend(rgb1, rgb2);
+#else
+    fragColor.rgb = mix(rgb1, qgfx_blend(rgb1, rgb2), color2.a);
+#endif
+#if QGFX_OPAQUE_BACKGROUND
+    fragColor.a = 1.0;
+#else
+    fragColor.rbg *= a;
+    fragColor.a = a;
+#endif
+    fragColor *= qt_Opacity;
+}
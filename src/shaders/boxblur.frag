@@ -0,0 +1,58 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2022 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#version 440
+
+// boxRadius must not exceed 64.
+
+layout(std140, binding = 0) uniform buf {
+    mat4 qt_Matrix;
+    float qt_Opacity;
+    float boxRadius;
+    vec2 dirstep;
+    float dither;
+};
+
+layout(binding = 1) uniform sampler2D source;
+layout(location = 0) in vec2 qt_TexCoord0;
+layout(location = 0) out vec4 fragColor;
+
+#include "dither.glsl"
+
+void main() {
+    vec4 sum = texture(source, qt_TexCoord0);
+    for (int i = 0; i < 32; ++i) {
+        float first = float(i * 2) + 1.0;
+        if (first > boxRadius) {
+            break;
+        }
+        // A lone texel is left over at the end of odd radii.
+        float o = ((first + 1.0) <= boxRadius) ? (first + 0.5) : first;
+        float w = ((first + 1.0) <= boxRadius) ? 2.0 : 1.0;
+        sum += w * (texture(source, qt_TexCoord0 + dirstep * o)
+                  + texture(source, qt_TexCoord0 - dirstep * o));
+    }
+    fragColor = (qt_Opacity / (2.0 * boxRadius + 1.0)) * sum;
+    fragColor.rgb += dither * fragColor.a * qgfx_dither(gl_FragCoord.xy);
+}
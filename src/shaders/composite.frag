@@ -0,0 +1,147 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2022 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#version 440
+
+// The whole acrylic recipe on top of the blurred source in a single pass: the
+// saturation boost, the Exclusion blend with the exclusion color, the Lightness
+// blend with the luminosity color, the Color blend with the tint color, the
+// noise overlay and the fallback color. The blends are the same as the
+// corresponding modes of blend.frag, with constant foregrounds.
+
+layout(std140, binding = 0) uniform buf {
+    mat4 qt_Matrix;
+    float qt_Opacity;
+    vec4 luminosityColor;
+    vec4 tintColor;
+    vec4 fallbackColor;
+    vec2 noiseScale;
+    float noiseOpacity;
+    float fallback;
+    vec4 exclusionColor;
+    float saturation;
+};
+
+layout(binding = 1) uniform sampler2D source;
+layout(binding = 2) uniform sampler2D noiseSource;
+layout(location = 0) in vec2 qt_TexCoord0;
+layout(location = 1) in vec2 qt_TexCoord1;
+layout(location = 0) out vec4 fragColor;
+
+float RGBtoL(vec3 color) {
+    float cmin = min(color.r, min(color.g, color.b));
+    float cmax = max(color.r, max(color.g, color.b));
+    float l = (cmin + cmax) / 2.0;
+    return l;
+}
+
+vec3 RGBtoHSL(vec3 color) {
+    float cmin = min(color.r, min(color.g, color.b));
+    float cmax = max(color.r, max(color.g, color.b));
+    float h = 0.0;
+    float s = 0.0;
+    float l = (cmin + cmax) / 2.0;
+    float diff = cmax - cmin;
+
+    if (diff > 1.0 / 256.0) {
+        if (l < 0.5)
+            s = diff / (cmin + cmax);
+        else
+            s = diff / (2.0 - (cmin + cmax));
+
+        if (color.r == cmax)
+            h = (color.g - color.b) / diff;
+        else if (color.g == cmax)
+            h = 2.0 + (color.b - color.r) / diff;
+        else
+            h = 4.0 + (color.r - color.g) / diff;
+
+        h /= 6.0;
+    }
+    return vec3(h, s, l);
+}
+
+float hueToIntensity(float v1, float v2, float h) {
+    h = fract(h);
+    if (h < 1.0 / 6.0)
+        return v1 + (v2 - v1) * 6.0 * h;
+    else if (h < 1.0 / 2.0)
+        return v2;
+    else if (h < 2.0 / 3.0)
+        return v1 + (v2 - v1) * 6.0 * (2.0 / 3.0 - h);
+
+    return v1;
+}
+
+vec3 HSLtoRGB(vec3 color) {
+    float h = color.x;
+    float l = color.z;
+    float s = color.y;
+
+    if (s < 1.0 / 256.0)
+        return vec3(l, l, l);
+
+    float v1;
+    float v2;
+    if (l < 0.5)
+        v2 = l * (1.0 + s);
+    else
+        v2 = (l + s) - (s * l);
+
+    v1 = 2.0 * l - v2;
+
+    float d = 1.0 / 3.0;
+    float r = hueToIntensity(v1, v2, h + d);
+    float g = hueToIntensity(v1, v2, h);
+    float b = hueToIntensity(v1, v2, h - d);
+    return vec3(r, g, b);
+}
+
+void main() {
+    // All the colors come in premultiplied, like the textures.
+    vec4 background = texture(source, qt_TexCoord0);
+    float a = background.a;
+    vec3 rgb = background.rgb / max(1.0/256.0, a);
+
+    // Same weights as the saturate type of feColorMatrix.
+    float luma = dot(rgb, vec3(0.2126, 0.7152, 0.0722));
+    rgb = clamp(mix(vec3(luma), rgb, saturation), 0.0, 1.0);
+
+    vec3 exclusion = exclusionColor.rgb / max(1.0/256.0, exclusionColor.a);
+    rgb = mix(rgb, rgb + exclusion - 2.0 * rgb * exclusion, exclusionColor.a);
+
+    vec3 luminosity = luminosityColor.rgb / max(1.0/256.0, luminosityColor.a);
+    rgb = mix(rgb, HSLtoRGB(vec3(RGBtoHSL(rgb).xy, RGBtoL(luminosity))), luminosityColor.a);
+
+    vec3 tint = tintColor.rgb / max(1.0/256.0, tintColor.a);
+    rgb = mix(rgb, HSLtoRGB(vec3(RGBtoHSL(tint).xy, RGBtoL(rgb))), tintColor.a);
+
+    vec4 result = vec4(rgb * a, a);
+    // The noise texture is sampled without filtering, so wrapping it by hand
+    // leaves no seams between the tiles.
+    vec4 noise = noiseOpacity * texture(noiseSource, fract(qt_TexCoord1));
+    result = noise + (1.0 - noise.a) * result;
+
+    fragColor = qt_Opacity * mix(result, fallbackColor, fallback);
+}
@@ -0,0 +1,36 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2022 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+// 4x4 ordered dithering, keeps low precision or low resolution intermediates
+// from showing up as banding in the final pass. Shared by all the blur shaders
+// through an include directive, which src/CMakeLists.txt and
+// QGfxShaderBuilder::shaderSource() expand since qsb doesn't resolve includes.
+
+float qgfx_bayer2(vec2 a) { a = floor(a); return fract(dot(a, vec2(0.5, a.y * 0.75))); }
+float qgfx_bayer4(vec2 a) { return qgfx_bayer2(0.5 * a) * 0.25 + qgfx_bayer2(a); }
+
+// The thresholds are n / 16 for n in 0 ... 15, their mean is 15 / 32, so the
+// offset averages out to zero. One step of an 8 bit channel at most.
+float qgfx_dither(vec2 fragCoord) { return (qgfx_bayer4(fragCoord) - (15.0 / 32.0)) / 255.0; }
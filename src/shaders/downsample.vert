@@ -0,0 +1,52 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2022 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#version 440
+
+// One level of the blur pyramid, see QGfxBlurPyramid. The four taps sit on the
+// corners between the input texels, so each of them averages a 2x2 block thanks
+// to the linear filtering, giving a 4x4 box filter in total.
+
+layout(location = 0) in vec4 qt_Vertex;
+layout(location = 1) in vec2 qt_MultiTexCoord0;
+
+layout(std140, binding = 0) uniform buf {
+    mat4 qt_Matrix;
+    float qt_Opacity;
+    vec2 texelStep;
+};
+
+layout(location = 0) out vec2 qt_TexCoord0;
+layout(location = 1) out vec2 qt_TexCoord1;
+layout(location = 2) out vec2 qt_TexCoord2;
+layout(location = 3) out vec2 qt_TexCoord3;
+out gl_PerVertex { vec4 gl_Position; };
+
+void main() {
+    gl_Position = qt_Matrix * qt_Vertex;
+    qt_TexCoord0 = qt_MultiTexCoord0 + vec2(-texelStep.x, -texelStep.y);
+    qt_TexCoord1 = qt_MultiTexCoord0 + vec2( texelStep.x, -texelStep.y);
+    qt_TexCoord2 = qt_MultiTexCoord0 + vec2(-texelStep.x,  texelStep.y);
+    qt_TexCoord3 = qt_MultiTexCoord0 + vec2( texelStep.x,  texelStep.y);
+}
@@ -0,0 +1,116 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2022 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#version 440
+
+// Build-time version of qgfx_linearFragmentShader() in qgfxshaderbuilder.cpp,
+// for kernels without mask and alpha-only support. QGFX_BLUR_RADIUS must not
+// exceed 64.
+#ifndef QGFX_BLUR_RADIUS
+#  define QGFX_BLUR_RADIUS 0
+#endif
+
+// An opaque source only needs its color channels blurred, the alpha is known.
+#ifndef QGFX_OPAQUE
+#  define QGFX_OPAQUE 0
+#endif
+#if QGFX_OPAQUE
+#  define QGFX_COLOR vec3
+#  define QGFX_FETCH(uv) texture(source, uv).rgb
+#else
+#  define QGFX_COLOR vec4
+#  define QGFX_FETCH(uv) texture(source, uv)
+#endif
+
+// Same deviation as QuickGaussianBlur uses. All the arguments are constants,
+// so the weights and offsets are folded by the compiler.
+#define QGFX_DEVIATION ((float(QGFX_BLUR_RADIUS) + 1.0) / 3.3333)
+#define QGFX_WEIGHT(x) ((float(x) <= float(QGFX_BLUR_RADIUS)) \
+    ? exp(-float((x) * (x)) / (2.0 * QGFX_DEVIATION * QGFX_DEVIATION)) : 0.0)
+// Texels x and x + 1 are fetched with a single sample placed between them,
+// the linear filtering does the weighting for us.
+#define QGFX_TAP_PAIR(x) \
+    w = QGFX_WEIGHT(x) + QGFX_WEIGHT((x) + 1); \
+    o = (float(x) * QGFX_WEIGHT(x) + float((x) + 1) * QGFX_WEIGHT((x) + 1)) / w; \
+    wSum += 2.0 * w; \
+    result += w * (QGFX_FETCH(qt_TexCoord0 + pixelStep * o) \
+                 + QGFX_FETCH(qt_TexCoord0 - pixelStep * o));
+// QGFX_TAPS_<n>(x) expands to the n pairs starting at texel x. The pairs
+// start at the odd texels 1, 3, ... and the last one may reach one texel past
+// the radius, where the weight is zero.
+#define QGFX_TAPS_1(x) QGFX_TAP_PAIR(x)
+#define QGFX_TAPS_2(x) QGFX_TAPS_1(x) QGFX_TAPS_1((x) + 2)
+#define QGFX_TAPS_4(x) QGFX_TAPS_2(x) QGFX_TAPS_2((x) + 4)
+#define QGFX_TAPS_8(x) QGFX_TAPS_4(x) QGFX_TAPS_4((x) + 8)
+#define QGFX_TAPS_16(x) QGFX_TAPS_8(x) QGFX_TAPS_8((x) + 16)
+#define QGFX_TAPS_32(x) QGFX_TAPS_16(x) QGFX_TAPS_16((x) + 32)
+#define QGFX_PAIR_COUNT ((QGFX_BLUR_RADIUS + 1) / 2)
+
+layout(std140, binding = 0) uniform buf {
+    mat4 qt_Matrix;
+    float qt_Opacity;
+    float spread;
+    vec2 dirstep;
+    float dither;
+};
+
+layout(binding = 1) uniform sampler2D source;
+layout(location = 0) out vec4 fragColor;
+layout(location = 0) in vec2 qt_TexCoord0;
+
+#include "dither.glsl"
+
+void main() {
+    vec2 pixelStep = dirstep * spread;
+    float w = QGFX_WEIGHT(0);
+    float o = 0.0;
+    float wSum = w;
+    QGFX_COLOR result = w * QGFX_FETCH(qt_TexCoord0);
+    // One QGFX_TAPS_<n> block per set bit of the pair count, each one
+    // continuing where the smaller blocks before it stopped.
+#if (QGFX_PAIR_COUNT & 1) != 0
+    QGFX_TAPS_1(1)
+#endif
+#if (QGFX_PAIR_COUNT & 2) != 0
+    QGFX_TAPS_2(1 + 2 * (QGFX_PAIR_COUNT & 1))
+#endif
+#if (QGFX_PAIR_COUNT & 4) != 0
+    QGFX_TAPS_4(1 + 2 * (QGFX_PAIR_COUNT & 3))
+#endif
+#if (QGFX_PAIR_COUNT & 8) != 0
+    QGFX_TAPS_8(1 + 2 * (QGFX_PAIR_COUNT & 7))
+#endif
+#if (QGFX_PAIR_COUNT & 16) != 0
+    QGFX_TAPS_16(1 + 2 * (QGFX_PAIR_COUNT & 15))
+#endif
+#if (QGFX_PAIR_COUNT & 32) != 0
+    QGFX_TAPS_32(1 + 2 * (QGFX_PAIR_COUNT & 31))
+#endif
+#if QGFX_OPAQUE
+    fragColor = vec4((qt_Opacity / wSum) * result, qt_Opacity);
+#else
+    fragColor = (qt_Opacity / wSum) * result;
+#endif
+    fragColor.rgb += dither * fragColor.a * qgfx_dither(gl_FragCoord.xy);
+}
@@ -0,0 +1,83 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2022 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#version 440
+
+// Gaussian kernel driven by uniforms, see QGfxShaderBuilder::linearGaussianKernel().
+// Every kernel vector holds two linearly interpolated taps as (offset, weight)
+// pairs, mirrored around the center texel. ShaderEffect can't feed arrays, hence
+// the separate vectors. The weights are normalized on the CPU side already.
+#define QGFX_KERNEL_VECTORS 16
+
+layout(std140, binding = 0) uniform buf {
+    mat4 qt_Matrix;
+    float qt_Opacity;
+    float spread;
+    vec2 dirstep;
+    float dither;
+    float tapCount;
+    float centerWeight;
+    vec4 kernel0;
+    vec4 kernel1;
+    vec4 kernel2;
+    vec4 kernel3;
+    vec4 kernel4;
+    vec4 kernel5;
+    vec4 kernel6;
+    vec4 kernel7;
+    vec4 kernel8;
+    vec4 kernel9;
+    vec4 kernel10;
+    vec4 kernel11;
+    vec4 kernel12;
+    vec4 kernel13;
+    vec4 kernel14;
+    vec4 kernel15;
+};
+
+layout(binding = 1) uniform sampler2D source;
+layout(location = 0) out vec4 fragColor;
+layout(location = 0) in vec2 qt_TexCoord0;
+
+#include "dither.glsl"
+
+void main() {
+    vec4 kernel[QGFX_KERNEL_VECTORS] = vec4[](
+        kernel0, kernel1, kernel2, kernel3, kernel4, kernel5, kernel6, kernel7,
+        kernel8, kernel9, kernel10, kernel11, kernel12, kernel13, kernel14, kernel15);
+    vec2 pixelStep = dirstep * spread;
+    vec4 result = centerWeight * texture(source, qt_TexCoord0);
+    for (int i = 0; i < QGFX_KERNEL_VECTORS; ++i) {
+        if (float(i * 2) >= tapCount) {
+            break;
+        }
+        vec4 k = kernel[i];
+        result += k.y * (texture(source, qt_TexCoord0 + pixelStep * k.x)
+                       + texture(source, qt_TexCoord0 - pixelStep * k.x));
+        result += k.w * (texture(source, qt_TexCoord0 + pixelStep * k.z)
+                       + texture(source, qt_TexCoord0 - pixelStep * k.z));
+    }
+    fragColor = result * qt_Opacity;
+    fragColor.rgb += dither * fragColor.a * qgfx_dither(gl_FragCoord.xy);
+}
@@ -0,0 +1,51 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2022 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#version 440
+
+// Downsampling step of the dual Kawase blur. The four diagonal taps sit half
+// way between the texels of the (twice as large) input, texelStep is the size
+// of one output texel.
+
+layout(std140, binding = 0) uniform buf {
+    mat4 qt_Matrix;
+    float qt_Opacity;
+    float offset;
+    vec2 texelStep;
+    float dither;
+};
+
+layout(binding = 1) uniform sampler2D source;
+layout(location = 0) in vec2 qt_TexCoord0;
+layout(location = 0) out vec4 fragColor;
+
+void main() {
+    vec2 halfStep = 0.5 * texelStep * offset;
+    vec4 sum = 4.0 * texture(source, qt_TexCoord0);
+    sum += texture(source, qt_TexCoord0 - halfStep);
+    sum += texture(source, qt_TexCoord0 + halfStep);
+    sum += texture(source, qt_TexCoord0 + vec2(halfStep.x, -halfStep.y));
+    sum += texture(source, qt_TexCoord0 - vec2(halfStep.x, -halfStep.y));
+    fragColor = (qt_Opacity / 8.0) * sum;
+}
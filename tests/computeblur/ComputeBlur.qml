@@ -0,0 +1,65 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2022 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+import QtQuick
+import org.wangwenx190.QtAcrylicMaterial
+
+Rectangle {
+    id: root
+    width: 256
+    height: 256
+    color: Qt.color("white")
+
+    property int blurRadius: 8
+    property bool compute: false
+    readonly property bool ready: blur.ready
+
+    // Hard edges and saturated colors, where the two paths would drift apart first.
+    Grid {
+        id: content
+        anchors.fill: parent
+        columns: 8
+
+        Repeater {
+            model: 64
+
+            Rectangle {
+                width: content.width / content.columns
+                height: width
+                color: Qt.hsla((index * 7 % 64) / 64, 0.9, 0.25 + ((index % 3) * 0.25), 1)
+            }
+        }
+    }
+
+    // Twice the radius in samples keeps the kernel from being stretched, so the
+    // fragment path uses the same weights as the compute path.
+    GaussianBlur {
+        id: blur
+        anchors.fill: parent
+        source: content
+        radius: root.blurRadius
+        samples: (root.blurRadius * 2)
+        compute: root.compute
+    }
+}
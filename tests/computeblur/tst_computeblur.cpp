@@ -0,0 +1,177 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2022 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <QtTest/qtest.h>
+#include <QtTest/qsignalspy.h>
+#include <QtCore/qmath.h>
+#include <QtGui/qimage.h>
+#include <QtQml/qqmlengine.h>
+#include <QtQuick/qquickview.h>
+#include <QtQuick/qquickitem.h>
+#include <QtQuick/qsgrendererinterface.h>
+#if (QT_VERSION >= QT_VERSION_CHECK(6, 6, 0))
+#  include <rhi/qrhi.h>
+#endif
+
+// Both paths dither their output, and the fragment path rounds to 8 bits
+// between the passes, so they can't be expected to match exactly.
+static constexpr const int sc_tolerance = 3;
+// Frames rendered after the blur became ready, before the window is grabbed.
+static constexpr const int sc_settleFrames = 3;
+
+class tst_ComputeBlur : public QObject
+{
+    Q_OBJECT
+
+public:
+    static void initMain();
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void matchesFragmentPath_data();
+    void matchesFragmentPath();
+
+private:
+    [[nodiscard]] QImage render(const int radius, const bool compute);
+
+private:
+    QScopedPointer<QQuickView> m_view;
+    bool m_sceneGraphError = false;
+};
+
+void tst_ComputeBlur::initMain()
+{
+    // Has to be decided before the first window is created.
+    QQuickWindow::setGraphicsApi(QSGRendererInterface::Vulkan);
+}
+
+void tst_ComputeBlur::initTestCase()
+{
+#if (QT_VERSION < QT_VERSION_CHECK(6, 6, 0))
+    QSKIP("The compute path needs Qt 6.6 or newer.");
+#else
+    m_view.reset(new QQuickView);
+    // Without a handler Qt Quick aborts when Vulkan can't be initialized.
+    connect(m_view.get(), &QQuickWindow::sceneGraphError, this, [this](QQuickWindow::SceneGraphError, const QString &message){
+        qWarning() << message;
+        m_sceneGraphError = true;
+    });
+    m_view->engine()->addImportPath(QString::fromUtf8(QTACRYLICMATERIAL_TEST_IMPORT_PATH));
+    m_view->setResizeMode(QQuickView::SizeRootObjectToView);
+    m_view->resize(256, 256);
+    m_view->setSource(QUrl(u"qrc:/ComputeBlurTest/ComputeBlur.qml"_qs));
+    QVERIFY2(m_view->rootObject(), "Failed to load ComputeBlur.qml.");
+    m_view->show();
+    QVERIFY(QTest::qWaitForWindowExposed(m_view.get()));
+    QTest::qWaitFor([this](){ return (m_view->isSceneGraphInitialized() || m_sceneGraphError); });
+    if (m_sceneGraphError || !m_view->isSceneGraphInitialized()) {
+        QSKIP("Vulkan is not available.");
+    }
+    QCOMPARE(m_view->rendererInterface()->graphicsApi(), QSGRendererInterface::Vulkan);
+    QRhi * const rhi = m_view->rhi();
+    if (!rhi || !rhi->isFeatureSupported(QRhi::Compute)) {
+        QSKIP("The Vulkan implementation doesn't support compute shaders.");
+    }
+#endif
+}
+
+void tst_ComputeBlur::cleanupTestCase()
+{
+    m_view.reset();
+}
+
+void tst_ComputeBlur::matchesFragmentPath_data()
+{
+    QTest::addColumn<int>("radius");
+
+    QTest::newRow("small") << 4;
+    QTest::newRow("medium") << 16;
+    QTest::newRow("large") << 48;
+}
+
+void tst_ComputeBlur::matchesFragmentPath()
+{
+    QFETCH(const int, radius);
+
+    const QImage fragment = render(radius, false);
+    QVERIFY(!fragment.isNull());
+    const QImage compute = render(radius, true);
+    QVERIFY(!compute.isNull());
+    QCOMPARE(compute.size(), fragment.size());
+
+    // The fragment passes read the padded layer of the previous pass around the
+    // borders while the compute shader clamps to the source, so only the part
+    // the borders can't reach is compared.
+    const int margin = qCeil(radius * m_view->effectiveDevicePixelRatio());
+    int largestDifference = 0;
+    QPoint largestDifferencePos = {};
+    for (int y = margin; y < (fragment.height() - margin); ++y) {
+        const auto fragmentLine = reinterpret_cast<const QRgb *>(fragment.constScanLine(y));
+        const auto computeLine = reinterpret_cast<const QRgb *>(compute.constScanLine(y));
+        for (int x = margin; x < (fragment.width() - margin); ++x) {
+            const QRgb a = fragmentLine[x];
+            const QRgb b = computeLine[x];
+            const int difference = qMax(qMax(qAbs(qRed(a) - qRed(b)), qAbs(qGreen(a) - qGreen(b))),
+                                        qMax(qAbs(qBlue(a) - qBlue(b)), qAbs(qAlpha(a) - qAlpha(b))));
+            if (difference > largestDifference) {
+                largestDifference = difference;
+                largestDifferencePos = QPoint(x, y);
+            }
+        }
+    }
+    QVERIFY2(largestDifference <= sc_tolerance,
+             qPrintable(u"The paths differ by %1 at (%2, %3)."_qs.arg(largestDifference)
+                        .arg(largestDifferencePos.x()).arg(largestDifferencePos.y())));
+}
+
+QImage tst_ComputeBlur::render(const int radius, const bool compute)
+{
+    QObject * const root = m_view->rootObject();
+    root->setProperty("blurRadius", radius);
+    root->setProperty("compute", compute);
+    if (!QTest::qWaitFor([root](){ return root->property("ready").toBool(); })) {
+        qWarning() << "The blur didn't become ready.";
+        return {};
+    }
+    // The switch between the paths happens in the next polish, and the passes
+    // need a frame to fill their layers.
+    QSignalSpy frameSpy(m_view.get(), &QQuickWindow::frameSwapped);
+    m_view->update();
+    if (!QTest::qWaitFor([this, &frameSpy](){
+            if (frameSpy.count() < sc_settleFrames) {
+                m_view->update();
+                return false;
+            }
+            return true;
+        })) {
+        qWarning() << "No frames were rendered.";
+        return {};
+    }
+    return m_view->grabWindow().convertToFormat(QImage::Format_ARGB32_Premultiplied);
+}
+
+QTEST_MAIN(tst_ComputeBlur)
+
+#include "tst_computeblur.moc"